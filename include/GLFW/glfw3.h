@@ -1004,6 +1004,9 @@ extern "C" {
 #define GLFW_STICKY_KEYS            0x00033002
 #define GLFW_STICKY_MOUSE_BUTTONS   0x00033003
 #define GLFW_LOCK_KEY_MODS          0x00033004
+#define GLFW_EVENT_BATCHING         0x00033005
+#define GLFW_COALESCE_MOTION        0x00033006
+#define GLFW_INSTRUMENTATION        0x00033007
 
 #define GLFW_CURSOR_NORMAL          0x00034001
 #define GLFW_CURSOR_HIDDEN          0x00034002
@@ -1072,6 +1075,113 @@ extern "C" {
 
 #define GLFW_DONT_CARE              -1
 
+/*! @defgroup event_types Batched event types
+ *  @brief Types of the events returned by glfwGetEventBatch.
+ *
+ *  See [glfwGetEventBatch](@ref glfwGetEventBatch) for how these are used.
+ *
+ *  @ingroup input
+ *  @{ */
+
+/*! @brief A key event, as reported to the keyboard callback.
+ */
+#define GLFW_EVENT_KEY              1
+/*! @brief A mouse button event, as reported to the mouse button callback.
+ */
+#define GLFW_EVENT_MOUSE_BUTTON     2
+/*! @brief A cursor motion event, as reported to the cursor position callback.
+ */
+#define GLFW_EVENT_CURSOR_POS       3
+/*! @brief A scroll event, as reported to the scroll callback.
+ */
+#define GLFW_EVENT_SCROLL           4
+/*! @brief A cursor enter or leave event, as reported to the cursor enter
+ *  callback.
+ */
+#define GLFW_EVENT_CURSOR_ENTER     5
+/*! @} */
+
+/*! @defgroup watch_events Watch events
+ *  @brief File descriptor events for event loop watches.
+ *
+ *  See [glfwAddWatch](@ref glfwAddWatch) for how these are used.  They have
+ *  the same values as the corresponding `poll()` events.
+ *
+ *  @ingroup window
+ *  @{ */
+
+/*! @brief The file descriptor is readable.
+ */
+#define GLFW_WATCH_READABLE         0x0001
+/*! @brief The file descriptor is writable.
+ */
+#define GLFW_WATCH_WRITABLE         0x0004
+/*! @brief An error occurred on the file descriptor.
+ *
+ *  Only reported to the callback, it is not necessary to request it.
+ */
+#define GLFW_WATCH_ERROR            0x0008
+/*! @brief The other end of the file descriptor was closed.
+ *
+ *  Only reported to the callback, it is not necessary to request it.
+ */
+#define GLFW_WATCH_HANGUP           0x0010
+/*! @} */
+
+/*! @defgroup timings Window timings
+ *  @brief Timings recorded for windows with instrumentation enabled.
+ *
+ *  See [glfwGetWindowHistogram](@ref glfwGetWindowHistogram) for how these
+ *  are used.
+ *
+ *  @ingroup input
+ *  @{ */
+
+/*! @brief The time from the event loop waking up to an input event being
+ *  reported to its callback or queued.
+ */
+#define GLFW_EVENT_LATENCY          1
+/*! @brief The time spent in input callbacks.
+ */
+#define GLFW_CALLBACK_DURATION      2
+/*! @brief The time spent in @ref glfwSwapBuffers.
+ */
+#define GLFW_SWAP_DURATION          3
+/*! @} */
+
+/*! @defgroup presentation_flags Frame presentation flags
+ *  @brief How a frame was presented.
+ *
+ *  See [glfwSetWindowFramePresentedCallback](@ref
+ *  glfwSetWindowFramePresentedCallback) for how these are used.  They have the
+ *  same values as the `wp_presentation_feedback` kinds of Wayland.
+ *
+ *  @ingroup window
+ *  @{ */
+
+/*! @brief The frame was presented in sync with the display refresh, so it did
+ *  not tear.
+ */
+#define GLFW_PRESENTATION_VSYNC         0x0001
+/*! @brief The presentation time comes from the display hardware rather than
+ *  from a software estimate.
+ */
+#define GLFW_PRESENTATION_HW_CLOCK      0x0002
+/*! @brief The display hardware signalled the completion of the presentation.
+ */
+#define GLFW_PRESENTATION_HW_COMPLETION 0x0004
+/*! @brief The frame was scanned out directly from the window buffer, without
+ *  a copy.
+ */
+#define GLFW_PRESENTATION_ZERO_COPY     0x0008
+/*! @} */
+
+/*! @brief The number of buckets of a timing histogram.
+ *
+ *  @ingroup input
+ */
+#define GLFW_HISTOGRAM_BUCKETS      32
+
 
 /*************************************************************************
  * GLFW API types
@@ -1315,6 +1425,42 @@ typedef void (* GLFWframebuffersizefun)(GLFWwindow*,int,int);
  */
 typedef void (* GLFWwindowcontentscalefun)(GLFWwindow*,float,float);
 
+/*! @brief The function signature for window frame ready callbacks.
+ *
+ *  This is the function signature for window frame ready callback functions.
+ *
+ *  @param[in] window The window that is ready for a new frame.
+ *
+ *  @sa @ref glfwSetWindowFrameReadyCallback
+ *  @sa @ref glfwRequestWindowFrame
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+typedef void (* GLFWframereadyfun)(GLFWwindow*);
+
+/*! @brief The function signature for window frame presented callbacks.
+ *
+ *  This is the function signature for window frame presented callback
+ *  functions.
+ *
+ *  @param[in] window The window whose frame was presented.
+ *  @param[in] time The time, on the @ref glfwGetTime timeline, when the frame
+ *  started to appear on the display.
+ *  @param[in] refresh The refresh interval of the display, in seconds, or zero
+ *  if it is not known.
+ *  @param[in] flags Bit field of [presentation flags](@ref presentation_flags)
+ *  describing how the frame was presented.
+ *
+ *  @sa @ref glfwSetWindowFramePresentedCallback
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+typedef void (* GLFWframepresentedfun)(GLFWwindow*,double,double,int);
+
 /*! @brief The function signature for mouse button callbacks.
  *
  *  This is the function signature for mouse button callback functions.
@@ -1443,6 +1589,68 @@ typedef void (* GLFWkeyboardfun)(GLFWwindow*, int, int, int, int, const char*, i
  */
 typedef void (* GLFWdropfun)(GLFWwindow*,int,const char**);
 
+/*! @brief The function signature for clipboard data callbacks.
+ *
+ *  This is the function signature for clipboard data callbacks.
+ *
+ *  @param[in] data A chunk of the UTF-8 encoded clipboard contents.  It is
+ *  not null-terminated and may end in the middle of a multi-byte character.
+ *  @param[in] size The size of the chunk, in bytes.
+ *  @param[in] user_data The user data passed to @ref glfwGetClipboardData.
+ *
+ *  @sa @ref clipboard
+ *  @sa @ref glfwGetClipboardData
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+typedef void (* GLFWclipboarddatafun)(const char*,size_t,void*);
+
+/*! @brief The function signature for clipboard request callbacks.
+ *
+ *  This is the function signature for clipboard request callbacks, called
+ *  once when an asynchronous clipboard request completes.
+ *
+ *  @param[in] window The window that made the request.
+ *  @param[in] mime The MIME type that was requested.
+ *  @param[in] data The contents of the clipboard, followed by a null byte
+ *  that is not included in the size, or `NULL` if the request failed.  This
+ *  pointer is only valid until the callback returns.
+ *  @param[in] size The size of the contents, in bytes.
+ *  @param[in] user_data The user data passed to @ref glfwRequestClipboard.
+ *
+ *  @sa @ref clipboard
+ *  @sa @ref glfwRequestClipboard
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+typedef void (* GLFWclipboardrequestfun)(GLFWwindow*,const char*,const char*,size_t,void*);
+
+/*! @brief The function signature for clipboard data providers.
+ *
+ *  This is the function signature for clipboard data providers, called when
+ *  another application requests the clipboard contents in one of the types
+ *  passed to @ref glfwSetClipboardProvider.
+ *
+ *  @param[in] mime The MIME type requested.
+ *  @param[out] size Where to store the size of the data, in bytes.
+ *  @param[in] user_data The user data passed to @ref glfwSetClipboardProvider.
+ *  @return The contents of the clipboard in the requested type, or `NULL` if
+ *  they cannot be provided.  GLFW copies the data before the provider is
+ *  called again, so it only needs to remain valid until then.
+ *
+ *  @sa @ref clipboard
+ *  @sa @ref glfwSetClipboardProvider
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+typedef const char* (* GLFWclipboardproviderfun)(const char*,size_t*,void*);
+
 /*! @brief The function signature for monitor configuration callbacks.
  *
  *  This is the function signature for monitor configuration callback functions.
@@ -1478,6 +1686,37 @@ typedef void (* GLFWmonitorfun)(GLFWmonitor*,int);
  */
 typedef void (* GLFWjoystickfun)(int,int);
 
+/*! @brief The function signature for event loop watch callbacks.
+ *
+ *  This is the function signature for file descriptor watch callbacks.
+ *
+ *  @param[in] fd The file descriptor that is ready.
+ *  @param[in] events The [events](@ref watch_events) that occurred.
+ *  @param[in] data The user data pointer passed to @ref glfwAddWatch.
+ *
+ *  @sa @ref glfwAddWatch
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+typedef void (* GLFWwatchfun)(int,int,void*);
+
+/*! @brief The function signature for event loop timer callbacks.
+ *
+ *  This is the function signature for timer callbacks.
+ *
+ *  @param[in] timer_id The ID of the timer that expired.
+ *  @param[in] data The user data pointer passed to @ref glfwAddTimer.
+ *
+ *  @sa @ref glfwAddTimer
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+typedef void (* GLFWtimerfun)(unsigned long long,void*);
+
 /*! @brief Video mode type.
  *
  *  This describes a single video mode.
@@ -1586,6 +1825,117 @@ typedef struct GLFWgamepadstate
     float axes[6];
 } GLFWgamepadstate;
 
+/*! @brief Batched input event.
+ *
+ *  This describes a single input event queued while the @ref
+ *  GLFW_EVENT_BATCHING input mode is enabled.  Only the members relevant to
+ *  the event type are set, the others are zero.
+ *
+ *  @sa @ref glfwGetEventBatch
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+typedef struct GLFWevent
+{
+    /*! The [type](@ref event_types) of the event.
+     */
+    int type;
+    /*! The [key](@ref keys) of a key event.
+     */
+    int key;
+    /*! The system-specific scancode of a key event.
+     */
+    int scancode;
+    /*! The [mouse button](@ref buttons) of a mouse button event.
+     */
+    int button;
+    /*! `GLFW_PRESS`, `GLFW_RELEASE` or `GLFW_REPEAT` for key and mouse button
+     *  events.
+     */
+    int action;
+    /*! The [modifier key flags](@ref mods) of key and mouse button events.
+     */
+    int mods;
+    /*! The input method state of key events, or the flags of scroll events.
+     */
+    int flags;
+    /*! `GLFW_TRUE` if the cursor entered the window, for cursor enter events.
+     */
+    int entered;
+    /*! The cursor position of cursor motion events, or the offset of scroll
+     *  events.
+     */
+    double x, y;
+    /*! The time of the event, in seconds, as returned by @ref glfwGetTime.
+     */
+    double time;
+    /*! The UTF-8 encoded text of key events.  This is an empty string if the
+     *  key generated no text.
+     */
+    const char* text;
+} GLFWevent;
+
+/*! @brief Timing histogram.
+ *
+ *  This describes the distribution of a [timing](@ref timings) recorded for
+ *  a window.  Bucket zero counts samples shorter than one microsecond and
+ *  bucket _i_ counts samples of at least 2<sup>_i_-1</sup> and less than
+ *  2<sup>_i_</sup> microseconds.  The last bucket also counts all longer
+ *  samples.
+ *
+ *  @sa @ref glfwGetWindowHistogram
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+typedef struct GLFWhistogram
+{
+    /*! The number of samples.
+     */
+    unsigned long long count;
+    /*! The sum, minimum and maximum of the samples, in seconds.
+     */
+    double total, min, max;
+    /*! The number of samples in each bucket.
+     */
+    unsigned long long buckets[GLFW_HISTOGRAM_BUCKETS];
+} GLFWhistogram;
+
+/*! @brief Event loop statistics.
+ *
+ *  This describes the activity of the event loop.
+ *
+ *  @sa @ref glfwGetEventLoopStats
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+typedef struct GLFWeventloopstats
+{
+    /*! The number of times the event loop returned from waiting.
+     */
+    unsigned long long wakeups;
+    /*! The number of wakeups with nothing to do, before the timeout of the
+     *  wait expired.
+     */
+    unsigned long long spuriousWakeups;
+    /*! The number of calls to event processing functions that reported at
+     *  least one input event.
+     */
+    unsigned long long dispatches;
+    /*! The number of input events reported.
+     */
+    unsigned long long events;
+    /*! The largest number of input events reported by a single call to an
+     *  event processing function.
+     */
+    unsigned long long maxEventsPerDispatch;
+} GLFWeventloopstats;
+
 
 /*************************************************************************
  * GLFW API functions
@@ -3642,6 +3992,105 @@ GLFWAPI GLFWframebuffersizefun glfwSetFramebufferSizeCallback(GLFWwindow* window
  */
 GLFWAPI GLFWwindowcontentscalefun glfwSetWindowContentScaleCallback(GLFWwindow* window, GLFWwindowcontentscalefun cbfun);
 
+/*! @brief Sets the frame ready callback for the specified window.
+ *
+ *  This function sets the frame ready callback of the specified window, which
+ *  is called once after each call to @ref glfwRequestWindowFrame, when it is a
+ *  good time to draw a new frame of the window.
+ *
+ *  @param[in] window The window whose callback to set.
+ *  @param[in] cbfun The new callback, or `NULL` to remove the currently set
+ *  callback.
+ *  @return The previously set callback, or `NULL` if no callback was set or the
+ *  library had not been [initialized](@ref intro_init).
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwRequestWindowFrame
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+GLFWAPI GLFWframereadyfun glfwSetWindowFrameReadyCallback(GLFWwindow* window, GLFWframereadyfun cbfun);
+
+/*! @brief Requests a frame ready callback for the specified window.
+ *
+ *  This function asks for the [frame ready callback](@ref
+ *  glfwSetWindowFrameReadyCallback) of the specified window to be called the
+ *  next time a new frame of the window would be presented.  The request is
+ *  answered once, so an application rendering continuously requests the next
+ *  frame from the callback, before swapping buffers.  Requesting a frame while
+ *  one is already pending does nothing.
+ *
+ *  The callback is called from the event processing functions.  While a
+ *  request is pending and can be answered, @ref glfwWaitEvents and @ref
+ *  glfwWaitEventsTimeout do not block waiting for it.
+ *
+ *  @param[in] window The window to request a frame for.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @remark @wayland The request is a `wl_surface.frame` callback.  It is
+ *  committed right away, unless the window has been configured since the last
+ *  buffer swap, in which case the next swap carries it.  The compositor
+ *  answers it when it is about to repaint the outputs showing the window, and
+ *  not at all while the window is hidden, minimized or fully covered, so an
+ *  application drawing only from this callback stops rendering in those cases.
+ *  The swap interval should be set to zero to avoid blocking in @ref
+ *  glfwSwapBuffers as well.
+ *
+ *  @remark On other platforms the callback is called at the end of the next
+ *  event processing, unless the window is iconified, in which case it is held
+ *  until the window is restored.  Frames are then paced by the swap interval.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwSetWindowFrameReadyCallback
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+GLFWAPI void glfwRequestWindowFrame(GLFWwindow* window);
+
+/*! @brief Sets the frame presented callback for the specified window.
+ *
+ *  This function sets the frame presented callback of the specified window,
+ *  which is called when a frame of the window has been shown on the display.
+ *  Frames that are replaced by newer ones before being shown are not reported.
+ *
+ *  @param[in] window The window whose callback to set.
+ *  @param[in] cbfun The new callback, or `NULL` to remove the currently set
+ *  callback.
+ *  @return The previously set callback, or `NULL` if no callback was set or the
+ *  library had not been [initialized](@ref intro_init).
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @remark @wayland Frames swapped with @ref glfwSwapBuffers while a callback
+ *  is set are reported through the `wp_presentation` protocol, if the
+ *  compositor supports it.
+ *
+ *  @remark @x11 Frames swapped with @ref glfwSwapBuffers while a callback is
+ *  set are reported through the Present extension, if `libXpresent` is
+ *  available and the OpenGL driver presents through it.  The refresh interval
+ *  is measured from consecutive frames.
+ *
+ *  @remark Other platforms do not report presented frames.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref presentation_flags
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+GLFWAPI GLFWframepresentedfun glfwSetWindowFramePresentedCallback(GLFWwindow* window, GLFWframepresentedfun cbfun);
+
 /*! @brief Processes all pending events.
  *
  *  This function processes only those events that are already in the event
@@ -3803,15 +4252,184 @@ GLFWAPI void glfwWaitEventsTimeout(double timeout);
  */
 GLFWAPI void glfwPostEmptyEvent(void);
 
+/*! @brief Adds a file descriptor to the event loop.
+ *
+ *  This function makes the event processing functions wait for the specified
+ *  file descriptor along with window system events, and call the callback
+ *  when any of the requested events occur on it.  This allows a single thread
+ *  to wait for both window system and application I/O.
+ *
+ *  The callback is called from within @ref glfwPollEvents, @ref glfwWaitEvents
+ *  or @ref glfwWaitEventsTimeout.  It may add, remove and toggle watches and
+ *  timers, including its own.  Errors and hangups are always reported for
+ *  enabled watches.  GLFW does not close the file descriptor.
+ *
+ *  @param[in] fd The file descriptor to watch.
+ *  @param[in] events A bit field of the [events](@ref watch_events) to wait
+ *  for.
+ *  @param[in] enabled `GLFW_TRUE` to start watching immediately, or
+ *  `GLFW_FALSE` to start disabled.
+ *  @param[in] callback The function to call when the events occur.
+ *  @param[in] data A user data pointer passed to the callback.
+ *  @return The ID of the watch, or zero if an [error](@ref error_handling)
+ *  occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED, @ref
+ *  GLFW_OUT_OF_MEMORY and @ref GLFW_PLATFORM_ERROR.
+ *
+ *  @remark This function is only implemented on X11 and Wayland, on other
+ *  platforms it emits @ref GLFW_PLATFORM_ERROR.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwToggleWatch
+ *  @sa @ref glfwRemoveWatch
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+GLFWAPI unsigned long long glfwAddWatch(int fd, int events, int enabled, GLFWwatchfun callback, void* data);
+
+/*! @brief Enables or disables an event loop watch.
+ *
+ *  @param[in] watch_id The ID of the watch, as returned by @ref glfwAddWatch.
+ *  @param[in] enabled `GLFW_TRUE` to watch the file descriptor, or
+ *  `GLFW_FALSE` to stop watching it.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED and @ref
+ *  GLFW_PLATFORM_ERROR.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwAddWatch
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+GLFWAPI void glfwToggleWatch(unsigned long long watch_id, int enabled);
+
+/*! @brief Removes a file descriptor from the event loop.
+ *
+ *  Removing a watch that has already been removed does nothing.
+ *
+ *  @param[in] watch_id The ID of the watch, as returned by @ref glfwAddWatch.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwAddWatch
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+GLFWAPI void glfwRemoveWatch(unsigned long long watch_id);
+
+/*! @brief Adds a repeating timer to the event loop.
+ *
+ *  This function adds a timer that calls the callback every `interval`
+ *  seconds while it is enabled.  The callback is called from within the event
+ *  processing functions and may add, remove and toggle watches and timers,
+ *  including its own.
+ *
+ *  @param[in] interval The interval, in seconds, between calls.
+ *  @param[in] enabled `GLFW_TRUE` to start the timer immediately, or
+ *  `GLFW_FALSE` to start disabled.
+ *  @param[in] callback The function to call when the timer expires.
+ *  @param[in] data A user data pointer passed to the callback.
+ *  @return The ID of the timer, or zero if an [error](@ref error_handling)
+ *  occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED, @ref
+ *  GLFW_OUT_OF_MEMORY and @ref GLFW_PLATFORM_ERROR.
+ *
+ *  @remark This function is only implemented on X11 and Wayland, on other
+ *  platforms it emits @ref GLFW_PLATFORM_ERROR.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwToggleTimer
+ *  @sa @ref glfwChangeTimerInterval
+ *  @sa @ref glfwRemoveTimer
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+GLFWAPI unsigned long long glfwAddTimer(double interval, int enabled, GLFWtimerfun callback, void* data);
+
+/*! @brief Enables or disables an event loop timer.
+ *
+ *  Enabling a timer schedules it to expire one interval from now.
+ *
+ *  @param[in] timer_id The ID of the timer, as returned by @ref glfwAddTimer.
+ *  @param[in] enabled `GLFW_TRUE` to enable the timer, or `GLFW_FALSE` to
+ *  disable it.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwAddTimer
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+GLFWAPI void glfwToggleTimer(unsigned long long timer_id, int enabled);
+
+/*! @brief Changes the interval of an event loop timer.
+ *
+ *  The new interval takes effect the next time the timer is scheduled.
+ *
+ *  @param[in] timer_id The ID of the timer, as returned by @ref glfwAddTimer.
+ *  @param[in] interval The new interval, in seconds.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwAddTimer
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+GLFWAPI void glfwChangeTimerInterval(unsigned long long timer_id, double interval);
+
+/*! @brief Removes a timer from the event loop.
+ *
+ *  Removing a timer that has already been removed does nothing.
+ *
+ *  @param[in] timer_id The ID of the timer, as returned by @ref glfwAddTimer.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwAddTimer
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup window
+ */
+GLFWAPI void glfwRemoveTimer(unsigned long long timer_id);
+
 /*! @brief Returns the value of an input option for the specified window.
  *
  *  This function returns the value of an input option for the specified window.
  *  The mode must be one of @ref GLFW_CURSOR, @ref GLFW_STICKY_KEYS,
- *  @ref GLFW_STICKY_MOUSE_BUTTONS or @ref GLFW_LOCK_KEY_MODS.
+ *  @ref GLFW_STICKY_MOUSE_BUTTONS, @ref GLFW_LOCK_KEY_MODS, @ref
+ *  GLFW_EVENT_BATCHING, @ref GLFW_COALESCE_MOTION or @ref
+ *  GLFW_INSTRUMENTATION.
  *
  *  @param[in] window The window to query.
  *  @param[in] mode One of `GLFW_CURSOR`, `GLFW_STICKY_KEYS`,
- *  `GLFW_STICKY_MOUSE_BUTTONS` or `GLFW_LOCK_KEY_MODS`.
+ *  `GLFW_STICKY_MOUSE_BUTTONS`, `GLFW_LOCK_KEY_MODS`, `GLFW_EVENT_BATCHING`,
+ *  `GLFW_COALESCE_MOTION` or `GLFW_INSTRUMENTATION`.
  *
  *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED and @ref
  *  GLFW_INVALID_ENUM.
@@ -3830,7 +4448,9 @@ GLFWAPI int glfwGetInputMode(GLFWwindow* window, int mode);
  *
  *  This function sets an input mode option for the specified window.  The mode
  *  must be one of @ref GLFW_CURSOR, @ref GLFW_STICKY_KEYS,
- *  @ref GLFW_STICKY_MOUSE_BUTTONS or @ref GLFW_LOCK_KEY_MODS.
+ *  @ref GLFW_STICKY_MOUSE_BUTTONS, @ref GLFW_LOCK_KEY_MODS, @ref
+ *  GLFW_EVENT_BATCHING, @ref GLFW_COALESCE_MOTION or @ref
+ *  GLFW_INSTRUMENTATION.
  *
  *  If the mode is `GLFW_CURSOR`, the value must be one of the following cursor
  *  modes:
@@ -3862,9 +4482,32 @@ GLFWAPI int glfwGetInputMode(GLFWwindow* window, int mode);
  *  GLFW_MOD_CAPS_LOCK bit set when the event was generated with Caps Lock on,
  *  and the @ref GLFW_MOD_NUM_LOCK bit when Num Lock was on.
  *
+ *  If the mode is `GLFW_EVENT_BATCHING`, the value must be either `GLFW_TRUE`
+ *  to enable event batching, or `GLFW_FALSE` to disable it.  If enabled, key,
+ *  mouse button, cursor motion, scroll and cursor enter events are queued on
+ *  the window instead of being passed to their callbacks, and are retrieved
+ *  with @ref glfwGetEventBatch.  This allows processing many events with
+ *  a single call.  Events already queued when batching is disabled remain
+ *  available.
+ *
+ *  If the mode is `GLFW_COALESCE_MOTION`, the value must be either `GLFW_TRUE`
+ *  to enable motion coalescing, or `GLFW_FALSE` to disable it.  If enabled,
+ *  consecutive cursor motion events received in one call to an event
+ *  processing function are reported as a single cursor position event with
+ *  the final position.  Relative motion, when the cursor is disabled, is
+ *  summed.  Pending motion is always reported before any other input event
+ *  for the window, so the order of events is preserved.  The individual
+ *  positions can be retrieved with @ref glfwGetCursorPosHistory.
+ *
+ *  If the mode is `GLFW_INSTRUMENTATION`, the value must be either
+ *  `GLFW_TRUE` to enable instrumentation, or `GLFW_FALSE` to disable it.  If
+ *  enabled, event latency, callback duration and buffer swap duration of the
+ *  window are recorded and can be retrieved with @ref glfwGetWindowHistogram.
+ *
  *  @param[in] window The window whose input mode to set.
  *  @param[in] mode One of `GLFW_CURSOR`, `GLFW_STICKY_KEYS`,
- *  `GLFW_STICKY_MOUSE_BUTTONS` or `GLFW_LOCK_KEY_MODS`.
+ *  `GLFW_STICKY_MOUSE_BUTTONS`, `GLFW_LOCK_KEY_MODS`, `GLFW_EVENT_BATCHING`,
+ *  `GLFW_COALESCE_MOTION` or `GLFW_INSTRUMENTATION`.
  *  @param[in] value The new value of the specified input mode.
  *
  *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED, @ref
@@ -3880,6 +4523,95 @@ GLFWAPI int glfwGetInputMode(GLFWwindow* window, int mode);
  */
 GLFWAPI void glfwSetInputMode(GLFWwindow* window, int mode, int value);
 
+/*! @brief Retrieves queued input events for the specified window.
+ *
+ *  This function copies up to `count` of the oldest input events queued on
+ *  the specified window while the @ref GLFW_EVENT_BATCHING input mode was
+ *  enabled into `events`, and removes them from the queue.  Events are
+ *  queued during event processing, so call this after @ref glfwPollEvents
+ *  or one of the wait functions.
+ *
+ *  @param[in] window The window whose events to retrieve.
+ *  @param[out] events Where to store the events.
+ *  @param[in] count The maximum number of events to store.
+ *  @return The number of events stored, or zero if none are queued or an
+ *  [error](@ref error_handling) occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @pointer_lifetime The text of key events is allocated and freed by GLFW.
+ *  You should not free it yourself.  It is valid until the next call to this
+ *  function or an event processing function, or until the window is
+ *  destroyed.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwSetInputMode
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+GLFWAPI int glfwGetEventBatch(GLFWwindow* window, GLFWevent* events, int count);
+
+/*! @brief Retrieves a timing histogram of the specified window.
+ *
+ *  This function retrieves the histogram of the specified
+ *  [timing](@ref timings) recorded for the window while the @ref
+ *  GLFW_INSTRUMENTATION input mode was enabled.  If `reset` is `GLFW_TRUE`
+ *  the histogram is cleared afterwards, so that calling this periodically
+ *  gives the distribution over each period.
+ *
+ *  Event latency is measured from the event loop returning from waiting for
+ *  the window system, and is not recorded for events that did not arrive
+ *  through the event loop.
+ *
+ *  @param[in] window The window to query.
+ *  @param[in] timing One of `GLFW_EVENT_LATENCY`, `GLFW_CALLBACK_DURATION` or
+ *  `GLFW_SWAP_DURATION`.
+ *  @param[out] histogram Where to store the histogram.
+ *  @param[in] reset Whether to clear the histogram.
+ *  @return `GLFW_TRUE` if successful, or `GLFW_FALSE` if an
+ *  [error](@ref error_handling) occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED and @ref
+ *  GLFW_INVALID_ENUM.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwSetInputMode
+ *  @sa @ref glfwGetEventLoopStats
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+GLFWAPI int glfwGetWindowHistogram(GLFWwindow* window, int timing, GLFWhistogram* histogram, int reset);
+
+/*! @brief Retrieves event loop statistics.
+ *
+ *  This function retrieves statistics about the activity of the event loop
+ *  since initialization or since they were last reset.  If `reset` is
+ *  `GLFW_TRUE` the statistics are cleared afterwards.
+ *
+ *  @param[out] stats Where to store the statistics.
+ *  @param[in] reset Whether to clear the statistics.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @remark Wakeups are only counted on platforms where GLFW runs its own
+ *  event loop, currently X11 and Wayland.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwGetWindowHistogram
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+GLFWAPI void glfwGetEventLoopStats(GLFWeventloopstats* stats, int reset);
+
 /*! @brief Returns the layout-specific name of the specified printable key.
  *
  *  This function returns the name of the specified printable key, encoded as
@@ -4117,6 +4849,38 @@ GLFWAPI void glfwGetCursorPos(GLFWwindow* window, double* xpos, double* ypos);
  */
 GLFWAPI void glfwSetCursorPos(GLFWwindow* window, double xpos, double ypos);
 
+/*! @brief Returns the cursor positions coalesced into the last motion event.
+ *
+ *  This function returns the individual cursor positions that were coalesced
+ *  into the most recent cursor position event of the specified window, while
+ *  the @ref GLFW_COALESCE_MOTION input mode is enabled.  The last position is
+ *  the one that was reported.
+ *
+ *  @param[in] window The window whose cursor history to retrieve.
+ *  @param[out] count Where to store the number of positions in the returned
+ *  array.  This is set to zero if coalescing is disabled or an
+ *  [error](@ref error_handling) occurred.
+ *  @return An array of `count` positions, as pairs of x and y coordinates in
+ *  the same coordinate system as the cursor position callback, oldest first,
+ *  or `NULL` if there are none.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @pointer_lifetime The returned array is allocated and freed by GLFW.  You
+ *  should not free it yourself.  It is valid until the next call to an event
+ *  processing function, or until the window is destroyed.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwSetCursorPosCallback
+ *  @sa @ref glfwSetInputMode
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+GLFWAPI const double* glfwGetCursorPosHistory(GLFWwindow* window, int* count);
+
 /*! @brief Creates a custom cursor.
  *
  *  Creates a new custom cursor image that can be set for a window with @ref
@@ -4855,6 +5619,48 @@ GLFWAPI int glfwGetGamepadState(int jid, GLFWgamepadstate* state);
  */
 GLFWAPI void glfwSetClipboardString(GLFWwindow* window, const char* string);
 
+/*! @brief Offers the clipboard contents in several types, converted on demand.
+ *
+ *  This function makes the application the owner of the system clipboard,
+ *  offering its contents in each of the specified MIME types.  The contents
+ *  are not converted up front.  Instead, the provider is called the first time
+ *  any application requests a given type, and its data is reused for later
+ *  requests of that type until the clipboard changes.
+ *
+ *  Offering a text type, such as `text/plain;charset=utf-8`, makes the
+ *  contents available as text to applications that request the usual text
+ *  targets, and to @ref glfwGetClipboardString.
+ *
+ *  The clipboard is owned until @ref glfwSetClipboardString or this function
+ *  is called again, or until another application takes ownership of it.
+ *
+ *  @param[in] window Deprecated.  Any valid window or `NULL`.
+ *  @param[in] mime_types The MIME types to offer.
+ *  @param[in] count The number of MIME types.
+ *  @param[in] provider The function converting the contents to a MIME type.
+ *  @param[in] user_data Arbitrary data passed to the provider.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED and @ref
+ *  GLFW_PLATFORM_ERROR.
+ *
+ *  @remark @x11 @wayland The provider is called from the event processing
+ *  functions, or from @ref glfwTerminate when handing the clipboard over to a
+ *  clipboard manager.  On other platforms only text is offered, and it is
+ *  requested from the provider immediately.
+ *
+ *  @pointer_lifetime The MIME types are copied before this function returns.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref clipboard
+ *  @sa @ref glfwSetClipboardString
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+GLFWAPI void glfwSetClipboardProvider(GLFWwindow* window, const char* const* mime_types, int count, GLFWclipboardproviderfun provider, void* user_data);
+
 /*! @brief Returns the contents of the clipboard as a string.
  *
  *  This function returns the contents of the system clipboard, if it contains
@@ -4887,6 +5693,91 @@ GLFWAPI void glfwSetClipboardString(GLFWwindow* window, const char* string);
  */
 GLFWAPI const char* glfwGetClipboardString(GLFWwindow* window);
 
+/*! @brief Passes the contents of the clipboard to a callback as they arrive.
+ *
+ *  This function retrieves the contents of the system clipboard, if it
+ *  contains or is convertible to UTF-8 encoded text, and passes them to the
+ *  specified callback in chunks as they are received.  This allows large
+ *  clipboard contents to be processed incrementally, without holding all of
+ *  it in memory.  Unlike @ref glfwGetClipboardString, the contents may
+ *  contain null bytes.
+ *
+ *  If the transfer fails after some chunks have been passed to the callback,
+ *  `GLFW_FALSE` is returned and the chunks received so far should be
+ *  discarded.
+ *
+ *  @param[in] window Deprecated.  Any valid window or `NULL`.
+ *  @param[in] callback The function to pass the chunks to.
+ *  @param[in] user_data Arbitrary data passed to the callback.
+ *  @return `GLFW_TRUE` if the complete contents were passed to the callback,
+ *  or `GLFW_FALSE` if an [error](@ref error_handling) occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED, @ref
+ *  GLFW_FORMAT_UNAVAILABLE and @ref GLFW_PLATFORM_ERROR.
+ *
+ *  @remark @x11 Large contents are received incrementally from the owner of
+ *  the clipboard, and each increment is passed to the callback as it
+ *  arrives.
+ *
+ *  @remark @wayland The contents are passed to the callback as they are read
+ *  from the pipe they are received through.
+ *
+ *  @remark On other platforms the callback is called once with the whole
+ *  contents.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref clipboard
+ *  @sa @ref glfwGetClipboardString
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+GLFWAPI int glfwGetClipboardData(GLFWwindow* window, GLFWclipboarddatafun callback, void* user_data);
+
+/*! @brief Requests the contents of the clipboard without blocking.
+ *
+ *  This function starts retrieving the contents of the system clipboard in
+ *  the specified MIME type and returns immediately.  The transfer proceeds
+ *  as events are processed, and the callback is called once with the whole
+ *  contents when it completes, or with `NULL` data if it fails.  Unlike
+ *  @ref glfwGetClipboardString, a slow or unresponsive clipboard owner does
+ *  not stall the application.
+ *
+ *  If the window is destroyed before the request completes, the callback is
+ *  not called.
+ *
+ *  @param[in] window The window making the request.
+ *  @param[in] mime The MIME type to request, or `NULL` for UTF-8 encoded
+ *  text.
+ *  @param[in] callback The function to call when the request completes.
+ *  @param[in] user_data Arbitrary data passed to the callback.
+ *  @return `GLFW_TRUE` if the request was made and the callback will be
+ *  called, or `GLFW_FALSE` if an [error](@ref error_handling) occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED, @ref
+ *  GLFW_OUT_OF_MEMORY, @ref GLFW_FORMAT_UNAVAILABLE and @ref
+ *  GLFW_PLATFORM_ERROR.
+ *
+ *  @remark The callback may be called before this function returns, for
+ *  example when the clipboard is owned by this application.
+ *
+ *  @remark @x11 @wayland The request gives up if the clipboard owner makes
+ *  no progress for two seconds.  On other platforms the contents are
+ *  retrieved synchronously and only text is supported.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref clipboard
+ *  @sa @ref glfwGetClipboardData
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+GLFWAPI int glfwRequestClipboard(GLFWwindow* window, const char* mime, GLFWclipboardrequestfun callback, void* user_data);
+
 /*! @brief Returns the value of the GLFW timer.
  *
  *  This function returns the value of the GLFW timer.  Unless the timer has
@@ -4941,6 +5832,35 @@ GLFWAPI double glfwGetTime(void);
  */
 GLFWAPI void glfwSetTime(double time);
 
+/*! @brief Returns the time of the input event being reported.
+ *
+ *  This function returns the time at which the input event currently being
+ *  reported to a key, character, mouse button, cursor position, cursor enter
+ *  or scroll callback occurred, on the same clock as @ref glfwGetTime.  Where
+ *  the window system provides a timestamp for the event it is mapped onto the
+ *  GLFW timer, otherwise the time the event was processed is used.  Outside
+ *  of input callbacks this returns the current time.
+ *
+ *  Coalesced cursor motion is reported with the time of the last motion event.
+ *
+ *  @return The time of the event, in seconds, or zero if an
+ *  [error](@ref error_handling) occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @remark Window system timestamps have millisecond resolution.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref time
+ *  @sa @ref glfwGetTime
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup input
+ */
+GLFWAPI double glfwGetEventTime(void);
+
 /*! @brief Returns the current value of the raw timer.
  *
  *  This function returns the current value of the raw timer, measured in
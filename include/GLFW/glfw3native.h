@@ -485,6 +485,31 @@ GLFWAPI struct wl_output* glfwGetWaylandMonitor(GLFWmonitor* monitor);
  *  @ingroup native
  */
 GLFWAPI struct wl_surface* glfwGetWaylandWindow(GLFWwindow* window);
+
+/*! @brief Returns the contents of the clipboard in a sealed memfd.
+ *
+ *  This function receives the contents of the clipboard in the specified MIME
+ *  type directly into a sealed memory file, which can be mapped with `mmap`
+ *  without the contents ever being copied through a heap buffer.
+ *
+ *  @param[in] mime The MIME type to receive, or `NULL` for UTF-8 encoded text.
+ *  @param[out] size Where to store the size of the contents, or `NULL`.
+ *  @return A file descriptor owned by the caller, who must close it, or `-1`
+ *  if an [error](@ref error_handling) occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED, @ref
+ *  GLFW_FORMAT_UNAVAILABLE and @ref GLFW_PLATFORM_ERROR.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref clipboard
+ *  @sa glfwGetClipboardString
+ *
+ *  @since Added in version 4.0.
+ *
+ *  @ingroup native
+ */
+GLFWAPI int glfwGetWaylandClipboardFd(const char* mime, size_t* size);
 #endif
 
 #if defined(GLFW_EXPOSE_NATIVE_MIR)
@@ -651,7 +676,7 @@ GLFWAPI OSMesaContext glfwGetOSMesaContext(GLFWwindow* window);
  *
  *  @ingroup native
  */
-GLFWAPI int glfwGetXKBScancode(const char* keyName, GLFWbool caseSensitive);
+GLFWAPI int glfwGetXKBScancode(const char* keyName, int caseSensitive);
 #endif
 
 #ifdef __cplusplus
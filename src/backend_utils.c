@@ -15,15 +15,30 @@
 #include <float.h>
 #include <time.h>
 #include <stdio.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#endif
 
 #ifdef __NetBSD__
 #define ppoll pollts
 #endif
 
+#if defined(__linux__) && defined(_GLFW_TIMERFD)
+#define USE_TIMER_FD
+#endif
+
 static inline double
 monotonic() {
     struct timespec ts = {0};
-#ifdef CLOCK_HIGHRES
+#if defined(USE_TIMER_FD)
+    // timerfd deadlines are absolute CLOCK_MONOTONIC times
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#elif defined(CLOCK_HIGHRES)
 	clock_gettime(CLOCK_HIGHRES, &ts);
 #elif CLOCK_MONOTONIC_RAW
 	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
@@ -33,126 +48,303 @@ monotonic() {
 	return (((double)ts.tv_nsec) / 1e9) + (double)ts.tv_sec;
 }
 
-void
-update_fds(EventLoopData *eld) {
-    for (nfds_t i = 0; i < eld->watches_count; i++) {
-        Watch *w = eld->watches + i;
-        eld->fds[i].fd = w->fd;
-        eld->fds[i].events = w->enabled ? w->events : 0;
-    }
+static id_type watch_counter = 0;
+
+// Watch ids carry the index of their slot in the low 32 bits, so lookups are
+// O(1) and a stale id never matches a reused slot
+#define WATCH_SLOT(watch_id) ((nfds_t)((watch_id) & 0xffffffffu))
+
+static inline Watch*
+watchForId(EventLoopData *eld, id_type watch_id) {
+    nfds_t slot = WATCH_SLOT(watch_id);
+    if (watch_id && slot < eld->watches_count && eld->watches[slot].id == watch_id) return eld->watches + slot;
+    return NULL;
 }
 
-static id_type watch_counter = 0;
+static int
+ensureWatchCapacity(EventLoopData *eld, nfds_t count) {
+    if (count <= eld->watches_capacity) return 1;
+    nfds_t capacity = eld->watches_capacity ? eld->watches_capacity * 2 : 16;
+    Watch *watches = realloc(eld->watches, capacity * sizeof(eld->watches[0]));
+    if (!watches) return 0;
+    eld->watches = watches;
+    struct pollfd *fds = realloc(eld->fds, capacity * sizeof(eld->fds[0]));
+    if (!fds) return 0;
+    eld->fds = fds;
+    nfds_t *free_slots = realloc(eld->watches_free, capacity * sizeof(eld->watches_free[0]));
+    if (!free_slots) return 0;
+    eld->watches_free = free_slots;
+#ifdef __linux__
+    struct epoll_event *events = realloc(eld->epoll_events, capacity * sizeof(eld->epoll_events[0]));
+    if (!events) return 0;
+    eld->epoll_events = events;
+#endif
+    eld->watches_capacity = capacity;
+    return 1;
+}
+
+#ifdef __linux__
+// EPOLLIN, EPOLLOUT, EPOLLERR and EPOLLHUP have the same values as their poll()
+// counterparts, so watch events and revents are used with epoll unchanged.
+// Only enabled watches are registered, as epoll reports errors and hangups
+// even for fds with no requested events.
+
+static int
+epollRegister(EventLoopData *eld, Watch *w) {
+    struct epoll_event ev = { .events = w->events, .data.u64 = w->id };
+    w->registered_fd = w->fd;
+    if (epoll_ctl(eld->epoll_fd, EPOLL_CTL_ADD, w->fd, &ev) == 0) return 1;
+    if (errno != EEXIST) return 0;
+    // epoll allows only one registration per fd, but dbus uses separate read
+    // and write watches on the same socket, so register a duplicate instead
+    w->registered_fd = fcntl(w->fd, F_DUPFD_CLOEXEC, 0);
+    if (w->registered_fd < 0) return 0;
+    if (epoll_ctl(eld->epoll_fd, EPOLL_CTL_ADD, w->registered_fd, &ev) == 0) return 1;
+    close(w->registered_fd);
+    return 0;
+}
+
+static void
+epollUnregister(EventLoopData *eld, Watch *w) {
+    epoll_ctl(eld->epoll_fd, EPOLL_CTL_DEL, w->registered_fd, NULL);
+    if (w->registered_fd != w->fd) close(w->registered_fd);
+}
+#endif
+
+// Disabled watches are given a negative fd so that poll() ignores them
+static inline void
+updatePollFd(EventLoopData *eld, Watch *w) {
+    struct pollfd *pfd = eld->fds + WATCH_SLOT(w->id);
+    pfd->fd = w->enabled ? w->fd : -1;
+    pfd->events = w->events;
+    pfd->revents = 0;
+}
 
 id_type
 addWatch(EventLoopData *eld, const char* name, int fd, int events, int enabled, watch_callback_func cb, void *cb_data) {
-    if (eld->watches_count >= sizeof(eld->watches)/sizeof(eld->watches[0])) {
-        _glfwInputError(GLFW_PLATFORM_ERROR, "Too many watches added");
+    nfds_t slot = eld->watches_free_count ? eld->watches_free[eld->watches_free_count - 1] : eld->watches_count;
+    if (!ensureWatchCapacity(eld, slot + 1)) {
+        _glfwInputError(GLFW_OUT_OF_MEMORY, "Failed to allocate memory for watch");
         return 0;
     }
-    Watch *w = eld->watches + eld->watches_count++;
+    Watch *w = eld->watches + slot;
+    memset(w, 0, sizeof(*w));
     w->name = name;
     w->fd = fd; w->events = events; w->enabled = enabled;
     w->callback = cb;
     w->callback_data = cb_data;
-    w->id = ++watch_counter;
-    update_fds(eld);
+    w->id = (++watch_counter << 32) | slot;
+#ifdef __linux__
+    if (eld->epoll_fd > 0 && enabled && !epollRegister(eld, w)) {
+        _glfwInputError(GLFW_PLATFORM_ERROR, "Failed to add watch for %s to epoll with error: %s", name, strerror(errno));
+        w->id = 0;
+        return 0;
+    }
+#endif
+    if (slot == eld->watches_count) eld->watches_count++;
+    else eld->watches_free_count--;
+    updatePollFd(eld, w);
     return w->id;
 }
 
-#define removeX(which, item_id, update_func) {\
-    for (nfds_t i = 0; i < eld->which##_count; i++) { \
-        if (eld->which[i].id == item_id) { \
-            eld->which##_count--; \
-            if (i < eld->which##_count) { \
-                memmove(eld->which + i, eld->which + i + 1, sizeof(eld->which[0]) * (eld->which##_count - i)); \
-            } \
-            update_func(eld); break; \
-}}}
-
 void
 removeWatch(EventLoopData *eld, id_type watch_id) {
-    removeX(watches, watch_id, update_fds);
+    Watch *w = watchForId(eld, watch_id);
+    if (!w) return;
+    nfds_t slot = WATCH_SLOT(watch_id);
+#ifdef __linux__
+    if (eld->epoll_fd > 0 && w->enabled) epollUnregister(eld, w);
+#endif
+    memset(w, 0, sizeof(*w));
+    eld->fds[slot].fd = -1;
+    eld->fds[slot].events = 0;
+    eld->fds[slot].revents = 0;
+    eld->watches_free[eld->watches_free_count++] = slot;
 }
 
 void
 toggleWatch(EventLoopData *eld, id_type watch_id, int enabled) {
-    for (nfds_t i = 0; i < eld->watches_count; i++) {
-        if (eld->watches[i].id == watch_id) {
-            if (eld->watches[i].enabled != enabled) {
-                eld->watches[i].enabled = enabled;
-                update_fds(eld);
-            }
-            break;
-        }
+    Watch *w = watchForId(eld, watch_id);
+    if (!w || w->enabled == enabled) return;
+    w->enabled = enabled;
+    updatePollFd(eld, w);
+#ifdef __linux__
+    if (eld->epoll_fd > 0) {
+        if (!enabled) epollUnregister(eld, w);
+        else if (!epollRegister(eld, w)) _glfwInputError(GLFW_PLATFORM_ERROR, "Failed to add watch for %s to epoll with error: %s", w->name, strerror(errno));
     }
+#endif
 }
 
 static id_type timer_counter = 0;
 
+// Timer ids carry the index of their slot in the low 32 bits, as for watches
+#define TIMER_SLOT(timer_id) ((nfds_t)((timer_id) & 0xffffffffu))
+
+static inline Timer*
+timerForId(EventLoopData *eld, id_type timer_id) {
+    nfds_t slot = TIMER_SLOT(timer_id);
+    if (timer_id && slot < eld->timers_count && eld->timers[slot].id == timer_id) return eld->timers + slot;
+    return NULL;
+}
+
 static int
-compare_timers(const void *a_, const void *b_) {
-    const Timer *a = (const Timer*)a_, *b = (const Timer*)b_;
-    return (a->trigger_at > b->trigger_at) ? 1 : (a->trigger_at < b->trigger_at) ? -1 : 0;
+ensureTimerCapacity(EventLoopData *eld, nfds_t count) {
+    if (count <= eld->timers_capacity) return 1;
+    nfds_t capacity = eld->timers_capacity ? eld->timers_capacity * 2 : 16;
+    Timer *timers = realloc(eld->timers, capacity * sizeof(eld->timers[0]));
+    if (!timers) return 0;
+    eld->timers = timers;
+    nfds_t *heap = realloc(eld->timers_heap, capacity * sizeof(eld->timers_heap[0]));
+    if (!heap) return 0;
+    eld->timers_heap = heap;
+    nfds_t *free_slots = realloc(eld->timers_free, capacity * sizeof(eld->timers_free[0]));
+    if (!free_slots) return 0;
+    eld->timers_free = free_slots;
+    id_type *to_dispatch = realloc(eld->timers_to_dispatch, capacity * sizeof(eld->timers_to_dispatch[0]));
+    if (!to_dispatch) return 0;
+    eld->timers_to_dispatch = to_dispatch;
+    eld->timers_capacity = capacity;
+    return 1;
 }
 
+#define heap_trigger_at(i) (eld->timers[eld->timers_heap[i]].trigger_at)
+
 static inline void
-update_timers(EventLoopData *eld) {
-    if (eld->timers_count > 1) qsort(eld->timers, eld->timers_count, sizeof(eld->timers[0]), compare_timers);
+heap_swap(EventLoopData *eld, nfds_t a, nfds_t b) {
+    nfds_t slot = eld->timers_heap[a];
+    eld->timers_heap[a] = eld->timers_heap[b];
+    eld->timers_heap[b] = slot;
+    eld->timers[eld->timers_heap[a]].heap_index = a;
+    eld->timers[eld->timers_heap[b]].heap_index = b;
+}
+
+static void
+heap_sift_up(EventLoopData *eld, nfds_t i) {
+    while (i > 0) {
+        nfds_t parent = (i - 1) / 2;
+        if (heap_trigger_at(parent) <= heap_trigger_at(i)) break;
+        heap_swap(eld, i, parent);
+        i = parent;
+    }
+}
+
+static void
+heap_sift_down(EventLoopData *eld, nfds_t i) {
+    while (1) {
+        nfds_t smallest = i, left = 2 * i + 1, right = left + 1;
+        if (left < eld->timers_heap_count && heap_trigger_at(left) < heap_trigger_at(smallest)) smallest = left;
+        if (right < eld->timers_heap_count && heap_trigger_at(right) < heap_trigger_at(smallest)) smallest = right;
+        if (smallest == i) break;
+        heap_swap(eld, i, smallest);
+        i = smallest;
+    }
+}
+
+static void
+unqueue_timer(EventLoopData *eld, Timer *t) {
+    nfds_t i = t->heap_index;
+    if (i == TIMER_NOT_QUEUED) return;
+    t->heap_index = TIMER_NOT_QUEUED;
+    if (i < --eld->timers_heap_count) {
+        eld->timers_heap[i] = eld->timers_heap[eld->timers_heap_count];
+        eld->timers[eld->timers_heap[i]].heap_index = i;
+        heap_sift_up(eld, i);
+        heap_sift_down(eld, eld->timers[eld->timers_heap[i]].heap_index);
+    }
+}
+
+// Sets the trigger time of the timer and moves it to its place in the queue,
+// a trigger time of DBL_MAX means disabled and removes it from the queue
+static void
+schedule_timer(EventLoopData *eld, Timer *t, double trigger_at) {
+    t->trigger_at = trigger_at;
+    if (trigger_at == DBL_MAX) { unqueue_timer(eld, t); return; }
+    if (t->heap_index == TIMER_NOT_QUEUED) {
+        t->heap_index = eld->timers_heap_count++;
+        eld->timers_heap[t->heap_index] = t - eld->timers;
+        heap_sift_up(eld, t->heap_index);
+    } else {
+        heap_sift_up(eld, t->heap_index);
+        heap_sift_down(eld, t->heap_index);
+    }
 }
 
+#ifdef USE_TIMER_FD
+static void
+update_timer_fd(EventLoopData *eld) {
+    if (eld->timer_fd <= 0) return;
+    double trigger_at = eld->timers_heap_count ? heap_trigger_at(0) : 0;
+    if (trigger_at == eld->timer_fd_armed_at) return;
+    eld->timer_fd_armed_at = trigger_at;
+    struct itimerspec spec = {{0}};
+    if (trigger_at > 0) {
+        // round up so that the timer is never dispatched before it expires
+        spec.it_value.tv_sec = (time_t)trigger_at;
+        spec.it_value.tv_nsec = (long)((trigger_at - spec.it_value.tv_sec) * 1e9) + 1;
+        if (spec.it_value.tv_nsec >= 1000000000) { spec.it_value.tv_sec++; spec.it_value.tv_nsec -= 1000000000; }
+    }
+    timerfd_settime(eld->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+#else
+#define update_timer_fd(eld)
+#endif
+
 id_type
 addTimer(EventLoopData *eld, const char *name, double interval, int enabled, timer_callback_func cb, void *cb_data) {
-    if (eld->timers_count >= sizeof(eld->timers)/sizeof(eld->timers[0])) {
-        _glfwInputError(GLFW_PLATFORM_ERROR, "Too many timers added");
+    nfds_t slot = eld->timers_free_count ? eld->timers_free[eld->timers_free_count - 1] : eld->timers_count;
+    if (!ensureTimerCapacity(eld, slot + 1)) {
+        _glfwInputError(GLFW_OUT_OF_MEMORY, "Failed to allocate memory for timer");
         return 0;
     }
-    Timer *t = eld->timers + eld->timers_count++;
+    if (slot == eld->timers_count) eld->timers_count++;
+    else eld->timers_free_count--;
+    Timer *t = eld->timers + slot;
     t->interval = interval;
     t->name = name;
-    t->trigger_at = enabled ? monotonic() + interval : DBL_MAX;
     t->callback = cb;
     t->callback_data = cb_data;
-    t->id = ++timer_counter;
-    update_timers(eld);
+    t->id = (++timer_counter << 32) | slot;
+    t->heap_index = TIMER_NOT_QUEUED;
+    schedule_timer(eld, t, enabled ? monotonic() + interval : DBL_MAX);
+    update_timer_fd(eld);
     return t->id;
 }
 
 void
 removeTimer(EventLoopData *eld, id_type timer_id) {
-    removeX(timers, timer_id, update_timers);
+    Timer *t = timerForId(eld, timer_id);
+    if (!t) return;
+    unqueue_timer(eld, t);
+    memset(t, 0, sizeof(*t));
+    eld->timers_free[eld->timers_free_count++] = TIMER_SLOT(timer_id);
+    update_timer_fd(eld);
 }
 
 void
 toggleTimer(EventLoopData *eld, id_type timer_id, int enabled) {
-    for (nfds_t i = 0; i < eld->timers_count; i++) {
-        if (eld->timers[i].id == timer_id) {
-            double trigger_at = enabled ? (monotonic() + eld->timers[i].interval) : DBL_MAX;
-            if (trigger_at != eld->timers[i].trigger_at) {
-                eld->timers[i].trigger_at = trigger_at;
-                update_timers(eld);
-            }
-            break;
-        }
+    Timer *t = timerForId(eld, timer_id);
+    if (!t) return;
+    double trigger_at = enabled ? (monotonic() + t->interval) : DBL_MAX;
+    if (trigger_at != t->trigger_at) {
+        schedule_timer(eld, t, trigger_at);
+        update_timer_fd(eld);
     }
 }
 
 void
 changeTimerInterval(EventLoopData *eld, id_type timer_id, double interval) {
-    for (nfds_t i = 0; i < eld->timers_count; i++) {
-        if (eld->timers[i].id == timer_id) {
-            eld->timers[i].interval = interval;
-            break;
-        }
-    }
+    Timer *t = timerForId(eld, timer_id);
+    if (t) t->interval = interval;
 }
 
-
 double
 prepareForPoll(EventLoopData *eld, double timeout) {
-    for (nfds_t i = 0; i < eld->watches_count; i++) eld->fds[i].revents = 0;
-    if (!eld->timers_count || eld->timers[0].trigger_at == DBL_MAX) return timeout;
-    double now = monotonic(), next_repeat_at = eld->timers[0].trigger_at;
+#ifdef USE_TIMER_FD
+    if (eld->timer_fd > 0) return timeout;
+#endif
+    if (!eld->timers_heap_count) return timeout;
+    double now = monotonic(), next_repeat_at = heap_trigger_at(0);
     if (timeout < 0 || now + timeout > next_repeat_at) {
         timeout = next_repeat_at <= now ? 0 : next_repeat_at - now;
     }
@@ -167,86 +359,207 @@ pollWithTimeout(struct pollfd *fds, nfds_t nfds, double timeout) {
     return ppoll(fds, nfds, &tv, NULL);
 }
 
-static void
-dispatchEvents(EventLoopData *eld) {
+static int
+waitForWatches(EventLoopData *eld, double timeout) {
+#ifdef __linux__
+    if (eld->epoll_fd > 0) {
+        int ms = -1;
+        if (timeout >= 0) {
+            // round up so that we never wake up before the timeout expires
+            ms = timeout * 1e3 > INT_MAX ? INT_MAX : (int)(timeout * 1e3);
+            if (ms < timeout * 1e3) ms++;
+        }
+        return epoll_wait(eld->epoll_fd, eld->epoll_events, eld->watches_capacity, ms);
+    }
+#endif
+    if (timeout < 0) return poll(eld->fds, eld->watches_count, -1);
+    return pollWithTimeout(eld->fds, eld->watches_count, timeout);
+}
+
+// Callbacks can add and remove watches, so watches are always looked up afresh
+// rather than through pointers held across callbacks. Returns whether the
+// display fd (always the first watch) is ready, and sets num_dispatched to
+// the number of ready watches.
+static int
+dispatchEvents(EventLoopData *eld, int num_ready, unsigned *num_dispatched) {
+    int display_ready = 0;
+    *num_dispatched = 0;
+#ifdef __linux__
+    if (eld->epoll_fd > 0) {
+        for (int i = 0; i < num_ready; i++) {
+            id_type watch_id = eld->epoll_events[i].data.u64;
+            int revents = eld->epoll_events[i].events;
+            Watch *ww = watchForId(eld, watch_id);
+            if (ww && ww->enabled && (revents & (ww->events | POLLERR | POLLHUP))) {
+                if (WATCH_SLOT(watch_id) == 0) display_ready = 1;
+                (*num_dispatched)++;
+                if (ww->callback) ww->callback(ww->fd, revents, ww->callback_data);
+            }
+        }
+        return display_ready;
+    }
+#endif
     for (nfds_t i = 0; i < eld->watches_count; i++) {
         Watch *ww = eld->watches + i;
-        struct pollfd *pfd = eld->fds + i;
-        if (pfd->revents & ww->events) {
-            ww->ready = 1;
-            if (ww->callback) ww->callback(ww->fd, pfd->revents, ww->callback_data);
-        } else ww->ready = 0;
+        int revents = eld->fds[i].revents;
+        if (ww->id && ww->enabled && (revents & (ww->events | POLLERR | POLLHUP))) {
+            if (i == 0) display_ready = 1;
+            (*num_dispatched)++;
+            if (ww->callback) ww->callback(ww->fd, revents, ww->callback_data);
+        }
     }
+    return display_ready;
 }
 
 unsigned
 dispatchTimers(EventLoopData *eld) {
-    if (!eld->timers_count || eld->timers[0].trigger_at == DBL_MAX) return 0;
-    static struct { timer_callback_func func; id_type id; void* data; } dispatches[sizeof(eld->timers)/sizeof(eld->timers[0])];
+    if (!eld->timers_heap_count) return 0;
     unsigned num_dispatches = 0;
     double now = monotonic();
-    for (nfds_t i = 0; i < eld->timers_count && eld->timers[i].trigger_at <= now; i++) {
-        eld->timers[i].trigger_at = now + eld->timers[i].interval;
-        dispatches[num_dispatches].func = eld->timers[i].callback;
-        dispatches[num_dispatches].id = eld->timers[i].id;
-        dispatches[num_dispatches].data = eld->timers[i].callback_data;
-        num_dispatches++;
+    // Take the expired timers off the queue in deadline order, which costs
+    // O(log n) per expired timer, before any of them is rescheduled
+    while (eld->timers_heap_count && heap_trigger_at(0) <= now) {
+        Timer *t = eld->timers + eld->timers_heap[0];
+        eld->timers_to_dispatch[num_dispatches++] = t->id;
+        unqueue_timer(eld, t);
     }
+    for (unsigned i = 0; i < num_dispatches; i++) {
+        Timer *t = timerForId(eld, eld->timers_to_dispatch[i]);
+        schedule_timer(eld, t, now + t->interval);
+    }
+    update_timer_fd(eld);
     // we dispatch separately so that the callbacks can modify timers
     for (unsigned i = 0; i < num_dispatches; i++) {
-        dispatches[i].func(dispatches[i].id, dispatches[i].data);
+        Timer *t = timerForId(eld, eld->timers_to_dispatch[i]);
+        if (t) t->callback(t->id, t->callback_data);
     }
-    if (num_dispatches) update_timers(eld);
     return num_dispatches;
 }
 
 static void
 drain_wakeup_fd(int fd, int events, void* data) {
-    static char drain_buf[64];
-    while(read(fd, drain_buf, sizeof(drain_buf)) < 0 && errno == EINTR);
+    // A single read drains an eventfd, a pipe is read until it is empty
+    static char drain_buf[256];
+    ssize_t ret;
+    while((ret = read(fd, drain_buf, sizeof(drain_buf))) == sizeof(drain_buf) || (ret < 0 && errno == EINTR));
+}
+
+int
+initWakeupFds(EventLoopData *eld) {
+#ifdef __linux__
+    // an eventfd coalesces any number of wakeups into a single counter
+    eld->wakeupFds[0] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (eld->wakeupFds[0] > 0) {
+        eld->wakeupFds[1] = -1;
+        return 1;
+    }
+#endif
+    return pipe2(eld->wakeupFds, O_CLOEXEC | O_NONBLOCK) == 0;
 }
 
+void
+wakeupEventLoop(EventLoopData *eld) {
+#ifdef __linux__
+    if (eld->wakeupFds[1] < 0) {
+        static const uint64_t value = 1;
+        while (write(eld->wakeupFds[0], &value, sizeof(value)) < 0 && errno == EINTR);
+        return;
+    }
+#endif
+    while (write(eld->wakeupFds[1], "w", 1) < 0 && errno == EINTR);
+}
+
+#ifdef USE_TIMER_FD
+static void
+dispatch_timer_fd(int fd, int events, void* data) {
+    EventLoopData *eld = data;
+    uint64_t expirations;
+    while(read(fd, &expirations, sizeof(expirations)) < 0 && errno == EINTR);
+    // the timer fd is disarmed once it expires
+    eld->timer_fd_armed_at = 0;
+    dispatchTimers(eld);
+}
+#endif
+
 void
 initPollData(EventLoopData *eld, int wakeup_fd, int display_fd) {
+#ifdef __linux__
+    eld->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    // fallback to ppoll() if epoll is unavailable
+    if (eld->epoll_fd < 0) eld->epoll_fd = 0;
+#endif
     addWatch(eld, "display", display_fd, POLLIN, 1, NULL, NULL);
     addWatch(eld, "wakeup", wakeup_fd, POLLIN, 1, drain_wakeup_fd, NULL);
+#ifdef USE_TIMER_FD
+    // fallback to poll timeouts if timerfd is unavailable
+    eld->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (eld->timer_fd < 0 || !addWatch(eld, "timers", eld->timer_fd, POLLIN, 1, dispatch_timer_fd, eld)) {
+        closeFds(&eld->timer_fd, 1);
+        eld->timer_fd = 0;
+    } else {
+        eld->timer_fd_armed_at = 0;
+        update_timer_fd(eld);
+    }
+#endif
+}
+
+void
+finalizePollData(EventLoopData *eld) {
+#ifdef __linux__
+    if (eld->epoll_fd > 0) {
+        for (nfds_t i = 0; i < eld->watches_count; i++) {
+            if (eld->watches[i].id && eld->watches[i].enabled) epollUnregister(eld, eld->watches + i);
+        }
+    }
+    closeFds(&eld->epoll_fd, 1);
+    closeFds(&eld->timer_fd, 1);
+    eld->timer_fd = 0;
+    free(eld->epoll_events); eld->epoll_events = NULL;
+#endif
+    free(eld->watches); eld->watches = NULL;
+    free(eld->fds); eld->fds = NULL;
+    free(eld->watches_free); eld->watches_free = NULL;
+    eld->watches_count = 0; eld->watches_capacity = 0; eld->watches_free_count = 0;
+    free(eld->timers); eld->timers = NULL;
+    free(eld->timers_heap); eld->timers_heap = NULL;
+    free(eld->timers_free); eld->timers_free = NULL;
+    free(eld->timers_to_dispatch); eld->timers_to_dispatch = NULL;
+    eld->timers_count = 0; eld->timers_capacity = 0; eld->timers_heap_count = 0; eld->timers_free_count = 0;
 }
 
 
 int
 pollForEvents(EventLoopData *eld, double timeout) {
-    int read_ok = 0;
+    int read_ok = 0, timers_in_loop = 1;
     timeout = prepareForPoll(eld, timeout);
     int result;
-    double end_time = monotonic() + timeout;
+    double end_time = timeout >= 0 ? monotonic() + timeout : 0;
+#ifdef __linux__
+    // the timer fd watch dispatches the timers when they expire
+    if (eld->timer_fd > 0) timers_in_loop = 0;
+#endif
 
     while(1) {
+        unsigned num_timers = 0, num_watches = 0;
+        errno = 0;
+        result = waitForWatches(eld, timeout);
+        int saved_errno = errno;
+        eld->wakeups++;
+        if (result > 0) eld->woken_at = _glfwPlatformGetTimerValue();
+        if (timers_in_loop) num_timers = dispatchTimers(eld);
+        if (result > 0) {
+            read_ok = dispatchEvents(eld, result, &num_watches);
+            if (!num_watches && !num_timers) eld->spurious_wakeups++;
+            break;
+        }
         if (timeout >= 0) {
-            errno = 0;
-            result = pollWithTimeout(eld->fds, eld->watches_count, timeout);
-            int saved_errno = errno;
-            dispatchTimers(eld);
-            if (result > 0) {
-                dispatchEvents(eld);
-                read_ok = eld->watches[0].ready;
-                break;
-            }
             timeout = end_time - monotonic();
             if (timeout <= 0) break;
-            if (result < 0 && (saved_errno == EINTR || saved_errno == EAGAIN)) continue;
-            break;
-        } else {
-            errno = 0;
-            result = poll(eld->fds, eld->watches_count, -1);
-            int saved_errno = errno;
-            dispatchTimers(eld);
-            if (result > 0) {
-                dispatchEvents(eld);
-                read_ok = eld->watches[0].ready;
-            }
-            if (result < 0 && (saved_errno == EINTR || saved_errno == EAGAIN)) continue;
-            break;
         }
+        // woke up before the timeout without anything to do
+        if (!num_timers) eld->spurious_wakeups++;
+        if (result < 0 && (saved_errno == EINTR || saved_errno == EAGAIN)) continue;
+        break;
     }
     return read_ok;
 }
@@ -262,6 +575,109 @@ closeFds(int *fds, size_t count) {
     }
 }
 
+int
+initTransferBuffer(TransferBuffer *tb, int use_memfd) {
+    memset(tb, 0, sizeof(*tb));
+    tb->fd = -1;
+    if (use_memfd) {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+        tb->fd = memfd_create("glfw-transfer", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        return tb->fd >= 0;
+#else
+        errno = ENOSYS;
+        return 0;
+#endif
+    }
+    return 1;
+}
+
+// Writes all of data to fd, waiting for a non-blocking fd to become writable,
+// and returns whether it succeeded
+int
+writeAll(int fd, const char *data, size_t size) {
+    while (size) {
+        ssize_t ret = write(fd, data, size);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+                if (poll(&pfd, 1, -1) < 0 && errno != EINTR) return 0;
+                continue;
+            }
+            return 0;
+        }
+        data += ret; size -= ret;
+    }
+    return 1;
+}
+
+// Reads the next chunk from fd, returning its size, 0 at end of file, or -1
+// with errno set on failure
+ssize_t
+readIntoTransferBuffer(TransferBuffer *tb, int fd) {
+    ssize_t ret;
+    if (tb->fd >= 0) {
+#ifdef __linux__
+        // Move the pages from the pipe into the memfd without a user space copy
+        ret = splice(fd, NULL, tb->fd, NULL, 1024 * 1024, SPLICE_F_MOVE);
+        if (ret >= 0 || errno != EINVAL) {
+            if (ret > 0) tb->size += ret;
+            return ret;
+        }
+#endif
+        // fd is not a pipe
+        char buf[65536];
+        ret = read(fd, buf, sizeof(buf));
+        if (ret > 0) {
+            if (!writeAll(tb->fd, buf, ret)) return -1;
+            tb->size += ret;
+        }
+        return ret;
+    }
+    // Make room for everything already in the pipe, growing geometrically so
+    // that large transfers take linear time, and leaving room for a null byte
+    int available = 0;
+    size_t needed = 4096;
+    if (ioctl(fd, FIONREAD, &available) == 0 && (size_t)available > needed) needed = available;
+    if (tb->capacity - tb->size < needed + 1) {
+        size_t capacity = tb->capacity ? tb->capacity : 4096;
+        while (capacity - tb->size < needed + 1) capacity *= 2;
+        char *data = realloc(tb->data, capacity);
+        if (!data) { errno = ENOMEM; return -1; }
+        tb->data = data;
+        tb->capacity = capacity;
+    }
+    ret = read(fd, tb->data + tb->size, tb->capacity - tb->size - 1);
+    if (ret > 0) tb->size += ret;
+    return ret;
+}
+
+// Null terminates the heap buffer, or seals the memfd against modification
+int
+finishTransferBuffer(TransferBuffer *tb) {
+    if (tb->fd >= 0) {
+#if defined(__linux__) && defined(F_ADD_SEALS)
+        if (fcntl(tb->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) return 0;
+#endif
+        return 1;
+    }
+    if (!tb->data) {
+        tb->data = malloc(1);
+        if (!tb->data) return 0;
+        tb->capacity = 1;
+    }
+    tb->data[tb->size] = 0;
+    return 1;
+}
+
+void
+freeTransferBuffer(TransferBuffer *tb) {
+    free(tb->data);
+    if (tb->fd >= 0) close(tb->fd);
+    memset(tb, 0, sizeof(*tb));
+    tb->fd = -1;
+}
+
 // Splits and translates a text/uri-list into separate file paths
 // NOTE: This function destroys the provided string
 //
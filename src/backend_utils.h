@@ -27,17 +27,25 @@
 #pragma once
 #include <poll.h>
 #include <unistd.h>
+#include <stdint.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 
 typedef unsigned long long id_type;
 typedef void(*watch_callback_func)(int, int, void*);
 typedef void(*timer_callback_func)(id_type, void*);
 
 typedef struct {
-    int fd, events, enabled, ready;
+    int fd, events, enabled;
     watch_callback_func callback;
     void *callback_data;
     id_type id;
     const char *name;
+#ifdef __linux__
+    // The fd registered with epoll, a dup() of fd if fd is shared with another watch
+    int registered_fd;
+#endif
 } Watch;
 
 typedef struct {
@@ -46,17 +54,53 @@ typedef struct {
     timer_callback_func callback;
     void *callback_data;
     const char *name;
+    // Position in the timer queue, or TIMER_NOT_QUEUED if disabled
+    nfds_t heap_index;
 } Timer;
 
+#define TIMER_NOT_QUEUED ((nfds_t)-1)
+
 
 typedef struct {
-    struct pollfd fds[32];
+    // Watches live in stable slots, a free slot has id == 0. fds mirrors the
+    // slots, with fd == -1 for free slots, so that it can be passed to poll()
+    // directly. watches_free is a stack of the free slots below watches_count.
+    struct pollfd *fds;
+    Watch *watches;
+    nfds_t *watches_free;
+    nfds_t watches_count, watches_capacity, watches_free_count;
+    // With eventfd only wakeupFds[0] is used and wakeupFds[1] is -1
     int wakeupFds[2];
-    nfds_t watches_count, timers_count;
-    Watch watches[32];
-    Timer timers[128];
+#ifdef __linux__
+    int epoll_fd;
+    struct epoll_event *epoll_events;
+    // When timer_fd > 0 timers are driven by a timerfd armed at the earliest
+    // deadline instead of by the poll timeout
+    int timer_fd;
+    double timer_fd_armed_at;
+#endif
+    // Timers live in stable slots like watches. timers_heap is a binary
+    // min-heap of the slots of the enabled timers, ordered by trigger_at.
+    Timer *timers;
+    nfds_t *timers_heap, *timers_free;
+    id_type *timers_to_dispatch;
+    nfds_t timers_count, timers_capacity, timers_heap_count, timers_free_count;
+    // Statistics for instrumentation. woken_at is the raw GLFW timer value
+    // when waiting last returned with ready watches.
+    unsigned long long wakeups, spurious_wakeups;
+    uint64_t woken_at;
 } EventLoopData;
 
+// Data read from a file descriptor, either into a heap buffer that grows
+// geometrically or, to avoid copying large payloads through the heap, into a
+// memfd that the consumer can mmap once it is sealed.
+typedef struct {
+    char *data;
+    size_t size, capacity;
+    // The memfd receiving the data instead of the heap buffer, or -1
+    int fd;
+} TransferBuffer;
+
 
 id_type addWatch(EventLoopData *eld, const char *name, int fd, int events, int enabled, watch_callback_func cb, void *cb_data);
 void removeWatch(EventLoopData *eld, id_type watch_id);
@@ -70,5 +114,13 @@ int pollWithTimeout(struct pollfd *fds, nfds_t nfds, double timeout);
 int pollForEvents(EventLoopData *eld, double timeout);
 unsigned dispatchTimers(EventLoopData *eld);
 void closeFds(int *fds, size_t count);
+int writeAll(int fd, const char *data, size_t size);
+int initWakeupFds(EventLoopData *eld);
+void wakeupEventLoop(EventLoopData *eld);
 void initPollData(EventLoopData *eld, int wakeup_fd, int display_fd);
+void finalizePollData(EventLoopData *eld);
+int initTransferBuffer(TransferBuffer *tb, int use_memfd);
+ssize_t readIntoTransferBuffer(TransferBuffer *tb, int fd);
+int finishTransferBuffer(TransferBuffer *tb);
+void freeTransferBuffer(TransferBuffer *tb);
 char** parseUriList(char* text, int* count);
@@ -1777,6 +1777,15 @@ void _glfwPlatformSetWindowOpacity(_GLFWwindow* window, float opacity)
     [window->ns.object setAlphaValue:opacity];
 }
 
+void _glfwPlatformRequestWindowFrame(_GLFWwindow* window)
+{
+    window->frameRequested = GLFW_TRUE;
+}
+
+void _glfwPlatformPrepareFramePresentation(_GLFWwindow* window)
+{
+}
+
 void _glfwPlatformPollEvents(void)
 {
     if (!initializeAppKit())
@@ -2035,6 +2044,51 @@ const char* _glfwPlatformGetClipboardString(void)
     return _glfw.ns.clipboardString;
 }
 
+GLFWbool _glfwPlatformGetClipboardData(GLFWclipboarddatafun callback, void* user_data)
+{
+    NSPasteboard* pasteboard = [NSPasteboard generalPasteboard];
+
+    if (![[pasteboard types] containsObject:NSStringPboardType])
+    {
+        _glfwInputError(GLFW_FORMAT_UNAVAILABLE,
+                        "Cocoa: Failed to retrieve string from pasteboard");
+        return GLFW_FALSE;
+    }
+
+    NSString* object = [pasteboard stringForType:NSStringPboardType];
+    if (!object)
+    {
+        _glfwInputError(GLFW_PLATFORM_ERROR,
+                        "Cocoa: Failed to retrieve object from pasteboard");
+        return GLFW_FALSE;
+    }
+
+    // The encoded data carries its own length, so contents with embedded
+    // nulls are passed on whole
+    NSData* data = [object dataUsingEncoding:NSUTF8StringEncoding];
+    if (!data)
+    {
+        _glfwInputError(GLFW_PLATFORM_ERROR,
+                        "Cocoa: Failed to convert pasteboard string to UTF-8");
+        return GLFW_FALSE;
+    }
+
+    callback([data bytes], [data length], user_data);
+    return GLFW_TRUE;
+}
+
+void _glfwPlatformSetClipboardProvider(void)
+{
+    size_t size;
+    const char* text = _glfwGetClipboardProviderData("text/plain;charset=utf-8", &size);
+
+    // Only text can be put on the clipboard, so the provider is not kept
+    if (text)
+        _glfwPlatformSetClipboardString(text);
+
+    _glfwFreeClipboardProvider(&_glfw.clipboardProvider);
+}
+
 void _glfwPlatformGetRequiredInstanceExtensions(char** extensions)
 {
     if (!_glfw.vk.KHR_surface || !_glfw.vk.MVK_macos_surface)
@@ -652,7 +652,16 @@ GLFWAPI void glfwSwapBuffers(GLFWwindow* handle)
         return;
     }
 
-    window->context.swapBuffers(window);
+    _glfwPlatformPrepareFramePresentation(window);
+
+    if (window->timings.enabled)
+    {
+        const double start = glfwGetTime();
+        window->context.swapBuffers(window);
+        _glfwInputSwapDuration(window, glfwGetTime() - start);
+    }
+    else
+        window->context.swapBuffers(window);
 }
 
 GLFWAPI void glfwSwapInterval(int interval)
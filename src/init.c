@@ -70,6 +70,9 @@ static void terminate(void)
     while (_glfw.windowListHead)
         glfwDestroyWindow((GLFWwindow*) _glfw.windowListHead);
 
+    _glfwWindowMapFree(&_glfw.windowsById);
+    _glfwFreeClipboardRequests();
+
     while (_glfw.cursorListHead)
         glfwDestroyCursor((GLFWcursor*) _glfw.cursorListHead);
 
@@ -91,6 +94,7 @@ static void terminate(void)
 
     _glfwTerminateVulkan();
     _glfwPlatformTerminate();
+    _glfwFreeClipboardProvider(&_glfw.clipboardProvider);
 
     _glfw.initialized = GLFW_FALSE;
 
@@ -250,6 +250,225 @@ static GLFWbool parseMapping(_GLFWmapping* mapping, const char* string)
 }
 
 
+// Drops the events already returned by glfwGetEventBatch
+//
+static void compactEvents(_GLFWwindow* window)
+{
+    memmove(window->batch.events,
+            window->batch.events + window->batch.head,
+            window->batch.count * sizeof(_GLFWbatchedEvent));
+    window->batch.head = 0;
+}
+
+// Drops the text of the key events already returned by glfwGetEventBatch
+//
+static void compactEventText(_GLFWwindow* window)
+{
+    size_t i;
+    const size_t textHead = window->batch.textHead;
+
+    window->batch.textSize -= textHead;
+    memmove(window->batch.text, window->batch.text + textHead, window->batch.textSize);
+    window->batch.textHead = 0;
+
+    for (i = 0;  i < window->batch.count;  i++)
+    {
+        _GLFWbatchedEvent* e = window->batch.events + window->batch.head + i;
+        if (e->event.type == GLFW_EVENT_KEY)
+            e->textOffset -= textHead;
+    }
+}
+
+// Returns the time of the event being reported, or the current time if the
+// window system did not provide one
+//
+static double eventTime(void)
+{
+    if (_glfw.eventTime.time > 0.0)
+        return _glfw.eventTime.time;
+
+    return glfwGetTime();
+}
+
+// Appends an event of the specified type to the batch of the window
+//
+static _GLFWbatchedEvent* queueEvent(_GLFWwindow* window, int type, size_t textLength)
+{
+    _GLFWbatchedEvent* e;
+
+    // Moving the pending events or text down only pays off once at least as
+    // much has been returned as is pending, otherwise the storage is grown
+    if (window->batch.head + window->batch.count == window->batch.capacity &&
+        window->batch.head >= window->batch.count)
+    {
+        compactEvents(window);
+    }
+
+    if (window->batch.head + window->batch.count == window->batch.capacity)
+    {
+        const size_t capacity = window->batch.capacity ? window->batch.capacity * 2 : 256;
+        _GLFWbatchedEvent* events = realloc(window->batch.events,
+                                            capacity * sizeof(_GLFWbatchedEvent));
+        if (!events)
+        {
+            _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+            return NULL;
+        }
+
+        window->batch.events = events;
+        window->batch.capacity = capacity;
+    }
+
+    if (type == GLFW_EVENT_KEY &&
+        window->batch.textSize + textLength + 1 > window->batch.textCapacity &&
+        window->batch.textHead >= window->batch.textSize - window->batch.textHead)
+    {
+        compactEventText(window);
+    }
+
+    if (type == GLFW_EVENT_KEY &&
+        window->batch.textSize + textLength + 1 > window->batch.textCapacity)
+    {
+        size_t capacity = window->batch.textCapacity ? window->batch.textCapacity * 2 : 1024;
+        char* text;
+
+        while (capacity < window->batch.textSize + textLength + 1)
+            capacity *= 2;
+
+        text = realloc(window->batch.text, capacity);
+        if (!text)
+        {
+            _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+            return NULL;
+        }
+
+        window->batch.text = text;
+        window->batch.textCapacity = capacity;
+    }
+
+    e = window->batch.events + window->batch.head + window->batch.count++;
+    memset(e, 0, sizeof(_GLFWbatchedEvent));
+    e->event.type = type;
+    e->event.time = eventTime();
+    return e;
+}
+
+
+// Adds a sample, in seconds, to the histogram
+//
+static void addSample(GLFWhistogram* histogram, double seconds)
+{
+    uint64_t micros;
+    int bucket = 0;
+
+    if (seconds < 0.0)
+        seconds = 0.0;
+
+    micros = (uint64_t) (seconds * 1e6);
+    while (micros && bucket < GLFW_HISTOGRAM_BUCKETS - 1)
+    {
+        micros >>= 1;
+        bucket++;
+    }
+
+    if (!histogram->count || seconds < histogram->min)
+        histogram->min = seconds;
+    if (!histogram->count || seconds > histogram->max)
+        histogram->max = seconds;
+
+    histogram->count++;
+    histogram->total += seconds;
+    histogram->buckets[bucket]++;
+}
+
+// Returns the time the event loop last woke up for the window system, or zero
+// if the events being reported did not arrive through the event loop
+//
+static double eventArrivalTime(void)
+{
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+    const uint64_t wokenAt = _GLFW_PLATFORM_EVENT_LOOP_DATA.woken_at;
+
+    if (_glfw.eventStats.processing && wokenAt > _glfw.timer.offset)
+    {
+        return (double) (wokenAt - _glfw.timer.offset) /
+            _glfwPlatformGetTimerFrequency();
+    }
+#endif
+
+    return 0.0;
+}
+
+// Counts an input event about to be reported and records its latency,
+// returning the time at which its callback is called if the window is
+// instrumented
+//
+static double beginEvent(_GLFWwindow* window)
+{
+    double now, arrival;
+
+    _glfw.eventStats.pending++;
+
+    if (!window->timings.enabled)
+        return 0.0;
+
+    now = glfwGetTime();
+    arrival = eventArrivalTime();
+    if (arrival > 0.0)
+        addSample(&window->timings.latency, now - arrival);
+
+    return now;
+}
+
+// Records the duration of a callback started by beginEvent
+//
+static void endEvent(_GLFWwindow* window, double start)
+{
+    if (window->timings.enabled && start > 0.0)
+        addSample(&window->timings.callback, glfwGetTime() - start);
+}
+
+// Reports a cursor position to the batch or the callback
+//
+static void deliverCursorPos(_GLFWwindow* window, double xpos, double ypos)
+{
+    const double start = beginEvent(window);
+
+    if (window->batch.enabled)
+    {
+        _GLFWbatchedEvent* e = queueEvent(window, GLFW_EVENT_CURSOR_POS, 0);
+        if (e)
+        {
+            e->event.x = xpos;
+            e->event.y = ypos;
+        }
+        return;
+    }
+
+    if (window->callbacks.cursorPos)
+    {
+        window->callbacks.cursorPos((GLFWwindow*) window, xpos, ypos);
+        endEvent(window, start);
+    }
+}
+
+// Reports coalesced cursor motion, if any, before other events of the window
+//
+static void flushMotion(_GLFWwindow* window)
+{
+    const double time = _glfw.eventTime.time;
+
+    if (!window->motion.pending)
+        return;
+
+    // The coalesced motion is reported with the time of its last event
+    window->motion.pending = GLFW_FALSE;
+    _glfw.eventTime.time = window->motion.time;
+    deliverCursorPos(window, window->virtualCursorPosX, window->virtualCursorPosY);
+    _glfw.eventTime.time = time;
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 //////                         GLFW event API                       //////
 //////////////////////////////////////////////////////////////////////////
@@ -258,6 +477,10 @@ static GLFWbool parseMapping(_GLFWmapping* mapping, const char* string)
 //
 void _glfwInputKeyboard(_GLFWwindow* window, int key, int scancode, int action, int mods, const char* text, int state)
 {
+    double start;
+
+    flushMotion(window);
+
     if (key >= 0 && key <= GLFW_KEY_LAST)
     {
         GLFWbool repeated = GLFW_FALSE;
@@ -277,10 +500,30 @@ void _glfwInputKeyboard(_GLFWwindow* window, int key, int scancode, int action,
             action = GLFW_REPEAT;
     }
 
+    start = beginEvent(window);
+
+    if (window->batch.enabled) {
+        const size_t length = text ? strlen(text) : 0;
+        _GLFWbatchedEvent* e = queueEvent(window, GLFW_EVENT_KEY, length);
+        if (e) {
+            if (!window->lockKeyMods) mods &= ~(GLFW_MOD_CAPS_LOCK | GLFW_MOD_NUM_LOCK);
+            e->event.key = key;
+            e->event.scancode = scancode;
+            e->event.action = action;
+            e->event.mods = mods;
+            e->event.flags = state;
+            e->textOffset = window->batch.textSize;
+            if (length) memcpy(window->batch.text + window->batch.textSize, text, length);
+            window->batch.text[window->batch.textSize + length] = 0;
+            window->batch.textSize += length + 1;
+        }
+        return;
+    }
 
     if (window->callbacks.keyboard) {
         if (!window->lockKeyMods) mods &= ~(GLFW_MOD_CAPS_LOCK | GLFW_MOD_NUM_LOCK);
         window->callbacks.keyboard((GLFWwindow*) window, key, scancode, action, mods, text, state);
+        endEvent(window, start);
     }
 }
 
@@ -288,17 +531,41 @@ void _glfwInputKeyboard(_GLFWwindow* window, int key, int scancode, int action,
 //
 void _glfwInputScroll(_GLFWwindow* window, double xoffset, double yoffset, int flags)
 {
+    double start;
+
+    flushMotion(window);
+    start = beginEvent(window);
+
+    if (window->batch.enabled)
+    {
+        _GLFWbatchedEvent* e = queueEvent(window, GLFW_EVENT_SCROLL, 0);
+        if (e)
+        {
+            e->event.x = xoffset;
+            e->event.y = yoffset;
+            e->event.flags = flags;
+        }
+        return;
+    }
+
     if (window->callbacks.scroll)
+    {
         window->callbacks.scroll((GLFWwindow*) window, xoffset, yoffset, flags);
+        endEvent(window, start);
+    }
 }
 
 // Notifies shared code of a mouse button click event
 //
 void _glfwInputMouseClick(_GLFWwindow* window, int button, int action, int mods)
 {
+    double start;
+
     if (button < 0 || button > GLFW_MOUSE_BUTTON_LAST)
         return;
 
+    flushMotion(window);
+
     if (!window->lockKeyMods)
         mods &= ~(GLFW_MOD_CAPS_LOCK | GLFW_MOD_NUM_LOCK);
 
@@ -307,8 +574,25 @@ void _glfwInputMouseClick(_GLFWwindow* window, int button, int action, int mods)
     else
         window->mouseButtons[button] = (char) action;
 
+    start = beginEvent(window);
+
+    if (window->batch.enabled)
+    {
+        _GLFWbatchedEvent* e = queueEvent(window, GLFW_EVENT_MOUSE_BUTTON, 0);
+        if (e)
+        {
+            e->event.button = button;
+            e->event.action = action;
+            e->event.mods = mods;
+        }
+        return;
+    }
+
     if (window->callbacks.mouseButton)
+    {
         window->callbacks.mouseButton((GLFWwindow*) window, button, action, mods);
+        endEvent(window, start);
+    }
 }
 
 // Notifies shared code of a cursor motion event
@@ -322,16 +606,57 @@ void _glfwInputCursorPos(_GLFWwindow* window, double xpos, double ypos)
     window->virtualCursorPosX = xpos;
     window->virtualCursorPosY = ypos;
 
-    if (window->callbacks.cursorPos)
-        window->callbacks.cursorPos((GLFWwindow*) window, xpos, ypos);
+    if (window->motion.enabled)
+    {
+        if (!window->motion.pending)
+        {
+            window->motion.pending = GLFW_TRUE;
+            window->motion.historyCount = 0;
+        }
+
+        if (window->motion.historyCount == window->motion.historyCapacity)
+        {
+            const int capacity = window->motion.historyCapacity ? window->motion.historyCapacity * 2 : 64;
+            double* history = realloc(window->motion.history, capacity * 2 * sizeof(double));
+            if (!history)
+                return;
+
+            window->motion.history = history;
+            window->motion.historyCapacity = capacity;
+        }
+
+        window->motion.time = eventTime();
+        window->motion.history[window->motion.historyCount * 2] = xpos;
+        window->motion.history[window->motion.historyCount * 2 + 1] = ypos;
+        window->motion.historyCount++;
+        return;
+    }
+
+    deliverCursorPos(window, xpos, ypos);
 }
 
 // Notifies shared code of a cursor enter/leave event
 //
 void _glfwInputCursorEnter(_GLFWwindow* window, GLFWbool entered)
 {
+    double start;
+
+    flushMotion(window);
+    start = beginEvent(window);
+
+    if (window->batch.enabled)
+    {
+        _GLFWbatchedEvent* e = queueEvent(window, GLFW_EVENT_CURSOR_ENTER, 0);
+        if (e)
+            e->event.entered = entered;
+        return;
+    }
+
     if (window->callbacks.cursorEnter)
+    {
         window->callbacks.cursorEnter((GLFWwindow*) window, entered);
+        endEvent(window, start);
+    }
 }
 
 // Notifies shared code of files or directories dropped on a window
@@ -342,6 +667,220 @@ void _glfwInputDrop(_GLFWwindow* window, int count, const char** paths)
         window->callbacks.drop((GLFWwindow*) window, count, paths);
 }
 
+// Notifies shared code that event processing is about to start
+//
+void _glfwInputBeginEvents(void)
+{
+    _glfw.eventStats.processing = GLFW_TRUE;
+    _glfw.eventStats.pending = 0;
+}
+
+// Notifies shared code that event processing is done, reporting the
+// coalesced cursor motion of all windows
+//
+void _glfwInputEndEvents(void)
+{
+    _GLFWwindow* window;
+
+    for (window = _glfw.windowListHead;  window;  window = window->next)
+        flushMotion(window);
+
+    _glfw.eventTime.time = 0.0;
+
+    if (_glfw.eventStats.pending)
+    {
+        _glfw.eventStats.dispatches++;
+        _glfw.eventStats.events += _glfw.eventStats.pending;
+        if (_glfw.eventStats.pending > _glfw.eventStats.maxEventsPerDispatch)
+            _glfw.eventStats.maxEventsPerDispatch = _glfw.eventStats.pending;
+    }
+
+    _glfw.eventStats.processing = GLFW_FALSE;
+    _glfw.eventStats.pending = 0;
+}
+
+// Records the duration of a buffer swap of the window
+//
+void _glfwInputSwapDuration(_GLFWwindow* window, double duration)
+{
+    addSample(&window->timings.swap, duration);
+}
+
+// Notifies shared code of the time of the events about to be reported, on
+// the glfwGetTime clock, or zero if unknown
+//
+void _glfwInputEventTime(double time)
+{
+    _glfw.eventTime.time = time;
+}
+
+// Notifies shared code of the window system timestamp, in milliseconds, of
+// the events about to be reported, or zero if unknown
+//
+void _glfwInputEventTimestamp(uint32_t milliseconds)
+{
+    uint64_t high = _glfw.eventTime.serverTimeHigh;
+    double server, now, offset;
+
+    if (!milliseconds)
+    {
+        _glfw.eventTime.time = 0.0;
+        return;
+    }
+
+    // The timestamps wrap around every 49.7 days, so extend them to 64 bits
+    // while allowing events to arrive slightly out of order around the wrap
+    if (_glfw.eventTime.hasServerOffset)
+    {
+        const uint32_t last = _glfw.eventTime.lastServerTime;
+
+        if (milliseconds < last && last - milliseconds > 0x80000000u)
+        {
+            high += (uint64_t) 1 << 32;
+            _glfw.eventTime.serverTimeHigh = high;
+            _glfw.eventTime.lastServerTime = milliseconds;
+        }
+        else if (milliseconds > last && milliseconds - last > 0x80000000u)
+        {
+            if (high)
+                high -= (uint64_t) 1 << 32;
+        }
+        else if (milliseconds > last)
+            _glfw.eventTime.lastServerTime = milliseconds;
+    }
+    else
+        _glfw.eventTime.lastServerTime = milliseconds;
+
+    server = (double) (high + milliseconds) / 1000.0;
+    now = glfwGetTime();
+
+    // An event cannot have been received before it happened, so the smallest
+    // difference between the clocks seen so far is the best estimate of the
+    // offset between them
+    offset = now - server;
+    if (!_glfw.eventTime.hasServerOffset || offset < _glfw.eventTime.serverOffset)
+    {
+        _glfw.eventTime.serverOffset = offset;
+        _glfw.eventTime.hasServerOffset = GLFW_TRUE;
+    }
+
+    _glfw.eventTime.time = server + _glfw.eventTime.serverOffset;
+    if (_glfw.eventTime.time <= 0.0)
+        _glfw.eventTime.time = now;
+}
+
+// Frees the batched events and motion history of the window
+//
+void _glfwFreeEventBatch(_GLFWwindow* window)
+{
+    free(window->batch.events);
+    free(window->batch.text);
+    memset(&window->batch, 0, sizeof(window->batch));
+    free(window->motion.history);
+    memset(&window->motion, 0, sizeof(window->motion));
+}
+
+// Appends data received for an asynchronous clipboard request
+//
+GLFWbool _glfwInputClipboardRequestData(_GLFWclipboardrequest* request,
+                                        const char* data, size_t size)
+{
+    // Leave room for the terminating null byte
+    if (request->size + size + 1 > request->capacity)
+    {
+        size_t capacity = request->capacity ? request->capacity : 4096;
+        char* grown;
+
+        while (capacity < request->size + size + 1)
+            capacity *= 2;
+
+        grown = realloc(request->data, capacity);
+        if (!grown)
+        {
+            _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+            return GLFW_FALSE;
+        }
+
+        request->data = grown;
+        request->capacity = capacity;
+    }
+
+    memcpy(request->data + request->size, data, size);
+    request->size += size;
+    request->data[request->size] = '\0';
+    return GLFW_TRUE;
+}
+
+// Completes an asynchronous clipboard request, passing the received data to
+// its callback on success, and frees it
+//
+void _glfwInputClipboardRequestDone(_GLFWclipboardrequest* request,
+                                    GLFWbool succeeded)
+{
+    _GLFWclipboardrequest** prev = &_glfw.clipboardRequestListHead;
+
+    while (*prev != request)
+        prev = &((*prev)->next);
+
+    *prev = request->next;
+
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+    if (request->watch)
+        removeWatch(&_GLFW_PLATFORM_EVENT_LOOP_DATA, request->watch);
+    if (request->timer)
+        removeTimer(&_GLFW_PLATFORM_EVENT_LOOP_DATA, request->timer);
+    if (request->fd >= 0)
+        close(request->fd);
+#endif
+
+    if (request->callback)
+    {
+        if (succeeded)
+        {
+            request->callback((GLFWwindow*) request->window, request->mime,
+                              request->data ? request->data : "",
+                              request->size, request->userData);
+        }
+        else
+        {
+            request->callback((GLFWwindow*) request->window, request->mime,
+                              NULL, 0, request->userData);
+        }
+    }
+
+    free(request->data);
+    free(request->mime);
+    free(request);
+}
+
+// Detaches the pending clipboard requests of the window, which complete
+// without calling their callbacks
+//
+void _glfwCancelClipboardRequests(_GLFWwindow* window)
+{
+    _GLFWclipboardrequest* request;
+
+    for (request = _glfw.clipboardRequestListHead;  request;  request = request->next)
+    {
+        if (request->window == window)
+        {
+            request->window = NULL;
+            request->callback = NULL;
+        }
+    }
+}
+
+// Frees all pending clipboard requests
+//
+void _glfwFreeClipboardRequests(void)
+{
+    while (_glfw.clipboardRequestListHead)
+    {
+        _glfw.clipboardRequestListHead->callback = NULL;
+        _glfwInputClipboardRequestDone(_glfw.clipboardRequestListHead, GLFW_FALSE);
+    }
+}
+
 // Notifies shared code of a joystick connection or disconnection
 //
 void _glfwInputJoystick(_GLFWjoystick* js, int event)
@@ -432,6 +971,105 @@ void _glfwFreeJoystick(_GLFWjoystick* js)
     memset(js, 0, sizeof(_GLFWjoystick));
 }
 
+// Returns whether the MIME type, or X11 target name, denotes UTF-8 text
+//
+GLFWbool _glfwIsTextMime(const char* mime)
+{
+    return strcmp(mime, "text/plain;charset=utf-8") == 0 ||
+           strcmp(mime, "text/plain") == 0 ||
+           strcmp(mime, "UTF8_STRING") == 0 ||
+           strcmp(mime, "STRING") == 0 ||
+           strcmp(mime, "TEXT") == 0;
+}
+
+// Returns the index of the offered clipboard type matching the MIME type, or
+// -1 if it is not offered.  Any text type matches the first one offered.
+//
+int _glfwFindClipboardProviderMime(const char* mime)
+{
+    int i;
+
+    for (i = 0;  i < _glfw.clipboardProvider.count;  i++)
+    {
+        if (strcmp(_glfw.clipboardProvider.mimes[i], mime) == 0)
+            return i;
+    }
+
+    if (_glfwIsTextMime(mime))
+    {
+        for (i = 0;  i < _glfw.clipboardProvider.count;  i++)
+        {
+            if (_glfwIsTextMime(_glfw.clipboardProvider.mimes[i]))
+                return i;
+        }
+    }
+
+    return -1;
+}
+
+// Returns the offered clipboard contents in the MIME type, followed by a null
+// byte, calling the provider the first time the type is requested
+//
+const char* _glfwGetClipboardProviderData(const char* mime, size_t* size)
+{
+    const int index = _glfwFindClipboardProviderMime(mime);
+    void* cache = _glfw.clipboardProvider.cache;
+
+    if (index < 0)
+        return NULL;
+
+    if (!_glfw.clipboardProvider.cache[index].provided)
+    {
+        size_t providedSize = 0;
+        const char* data;
+
+        _glfw.clipboardProvider.cache[index].provided = GLFW_TRUE;
+        data = _glfw.clipboardProvider.provider(_glfw.clipboardProvider.mimes[index],
+                                                &providedSize,
+                                                _glfw.clipboardProvider.userData);
+
+        // The provider may have replaced the clipboard
+        if (_glfw.clipboardProvider.cache != cache)
+            return NULL;
+
+        if (data)
+        {
+            char* copy = malloc(providedSize + 1);
+            if (!copy)
+            {
+                _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+                return NULL;
+            }
+
+            memcpy(copy, data, providedSize);
+            copy[providedSize] = '\0';
+            _glfw.clipboardProvider.cache[index].data = copy;
+            _glfw.clipboardProvider.cache[index].size = providedSize;
+        }
+    }
+
+    if (!_glfw.clipboardProvider.cache[index].data)
+        return NULL;
+
+    *size = _glfw.clipboardProvider.cache[index].size;
+    return _glfw.clipboardProvider.cache[index].data;
+}
+
+void _glfwFreeClipboardProvider(_GLFWclipboardprovider* provider)
+{
+    int i;
+
+    for (i = 0;  i < provider->count;  i++)
+    {
+        free(provider->mimes[i]);
+        free(provider->cache[i].data);
+    }
+
+    free(provider->mimes);
+    free(provider->cache);
+    memset(provider, 0, sizeof(_GLFWclipboardprovider));
+}
+
 const char* _glfwGetKeyName(int key)
 {
     switch (key)
@@ -585,6 +1223,12 @@ GLFWAPI int glfwGetInputMode(GLFWwindow* handle, int mode)
             return window->stickyMouseButtons;
         case GLFW_LOCK_KEY_MODS:
             return window->lockKeyMods;
+        case GLFW_EVENT_BATCHING:
+            return window->batch.enabled;
+        case GLFW_COALESCE_MOTION:
+            return window->motion.enabled;
+        case GLFW_INSTRUMENTATION:
+            return window->timings.enabled;
     }
 
     _glfwInputError(GLFW_INVALID_ENUM, "Invalid input mode 0x%08X", mode);
@@ -662,10 +1306,127 @@ GLFWAPI void glfwSetInputMode(GLFWwindow* handle, int mode, int value)
     }
     else if (mode == GLFW_LOCK_KEY_MODS)
         window->lockKeyMods = value ? GLFW_TRUE : GLFW_FALSE;
+    else if (mode == GLFW_EVENT_BATCHING)
+    {
+        flushMotion(window);
+        window->batch.enabled = value ? GLFW_TRUE : GLFW_FALSE;
+    }
+    else if (mode == GLFW_COALESCE_MOTION)
+    {
+        value = value ? GLFW_TRUE : GLFW_FALSE;
+        if (!value)
+        {
+            flushMotion(window);
+            window->motion.historyCount = 0;
+        }
+
+        window->motion.enabled = value;
+    }
+    else if (mode == GLFW_INSTRUMENTATION)
+        window->timings.enabled = value ? GLFW_TRUE : GLFW_FALSE;
     else
         _glfwInputError(GLFW_INVALID_ENUM, "Invalid input mode 0x%08X", mode);
 }
 
+GLFWAPI int glfwGetEventBatch(GLFWwindow* handle, GLFWevent* events, int count)
+{
+    int i;
+    _GLFWwindow* window = (_GLFWwindow*) handle;
+    assert(window != NULL);
+    assert(events != NULL || count == 0);
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(0);
+
+    // The events returned by the previous call are no longer needed
+    if (!window->batch.count)
+    {
+        window->batch.head = 0;
+        window->batch.textHead = window->batch.textSize = 0;
+    }
+
+    if (count <= 0)
+        return 0;
+
+    if ((size_t) count > window->batch.count)
+        count = (int) window->batch.count;
+
+    for (i = 0;  i < count;  i++)
+    {
+        const _GLFWbatchedEvent* e = window->batch.events + window->batch.head + i;
+        events[i] = e->event;
+        if (e->event.type == GLFW_EVENT_KEY)
+        {
+            events[i].text = window->batch.text + e->textOffset;
+            window->batch.textHead = e->textOffset + strlen(events[i].text) + 1;
+        }
+    }
+
+    // The returned events are only dropped when more space is needed, so
+    // that their text stays valid
+    window->batch.head += count;
+    window->batch.count -= count;
+    return count;
+}
+
+GLFWAPI int glfwGetWindowHistogram(GLFWwindow* handle, int timing, GLFWhistogram* histogram, int reset)
+{
+    GLFWhistogram* source;
+    _GLFWwindow* window = (_GLFWwindow*) handle;
+    assert(window != NULL);
+    assert(histogram != NULL);
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(GLFW_FALSE);
+
+    switch (timing)
+    {
+        case GLFW_EVENT_LATENCY:
+            source = &window->timings.latency;
+            break;
+        case GLFW_CALLBACK_DURATION:
+            source = &window->timings.callback;
+            break;
+        case GLFW_SWAP_DURATION:
+            source = &window->timings.swap;
+            break;
+        default:
+            _glfwInputError(GLFW_INVALID_ENUM, "Invalid timing 0x%08X", timing);
+            return GLFW_FALSE;
+    }
+
+    *histogram = *source;
+    if (reset)
+        memset(source, 0, sizeof(GLFWhistogram));
+
+    return GLFW_TRUE;
+}
+
+GLFWAPI void glfwGetEventLoopStats(GLFWeventloopstats* stats, int reset)
+{
+    assert(stats != NULL);
+
+    _GLFW_REQUIRE_INIT();
+
+    memset(stats, 0, sizeof(GLFWeventloopstats));
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+    stats->wakeups = _GLFW_PLATFORM_EVENT_LOOP_DATA.wakeups;
+    stats->spuriousWakeups = _GLFW_PLATFORM_EVENT_LOOP_DATA.spurious_wakeups;
+#endif
+    stats->dispatches = _glfw.eventStats.dispatches;
+    stats->events = _glfw.eventStats.events;
+    stats->maxEventsPerDispatch = _glfw.eventStats.maxEventsPerDispatch;
+
+    if (reset)
+    {
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+        _GLFW_PLATFORM_EVENT_LOOP_DATA.wakeups = 0;
+        _GLFW_PLATFORM_EVENT_LOOP_DATA.spurious_wakeups = 0;
+#endif
+        _glfw.eventStats.dispatches = 0;
+        _glfw.eventStats.events = 0;
+        _glfw.eventStats.maxEventsPerDispatch = 0;
+    }
+}
+
 GLFWAPI const char* glfwGetKeyName(int key, int scancode)
 {
     _GLFW_REQUIRE_INIT_OR_RETURN(NULL);
@@ -799,6 +1560,23 @@ GLFWAPI void glfwSetCursorPos(GLFWwindow* handle, double xpos, double ypos)
     }
 }
 
+GLFWAPI const double* glfwGetCursorPosHistory(GLFWwindow* handle, int* count)
+{
+    _GLFWwindow* window = (_GLFWwindow*) handle;
+    assert(window != NULL);
+    assert(count != NULL);
+
+    *count = 0;
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(NULL);
+
+    if (!window->motion.enabled || !window->motion.historyCount)
+        return NULL;
+
+    *count = window->motion.historyCount;
+    return window->motion.history;
+}
+
 GLFWAPI GLFWcursor* glfwCreateCursor(const GLFWimage* image, int xhot, int yhot, int count)
 {
     _GLFWcursor* cursor;
@@ -1367,6 +2145,54 @@ GLFWAPI void glfwSetClipboardString(GLFWwindow* handle, const char* string)
 
     _GLFW_REQUIRE_INIT();
     _glfwPlatformSetClipboardString(string);
+    _glfwFreeClipboardProvider(&_glfw.clipboardProvider);
+}
+
+GLFWAPI void glfwSetClipboardProvider(GLFWwindow* handle,
+                                      const char* const* mime_types,
+                                      int count,
+                                      GLFWclipboardproviderfun provider,
+                                      void* user_data)
+{
+    _GLFWclipboardprovider next, previous;
+
+    assert(mime_types != NULL || count == 0);
+    assert(count >= 0);
+    assert(provider != NULL);
+
+    _GLFW_REQUIRE_INIT();
+
+    memset(&next, 0, sizeof(next));
+    next.mimes = calloc(count ? count : 1, sizeof(char*));
+    next.cache = calloc(count ? count : 1, sizeof(next.cache[0]));
+    if (!next.mimes || !next.cache)
+    {
+        free(next.mimes);
+        free(next.cache);
+        _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+        return;
+    }
+
+    next.provider = provider;
+    next.userData = user_data;
+
+    for (next.count = 0;  next.count < count;  next.count++)
+    {
+        next.mimes[next.count] = _glfw_strdup(mime_types[next.count]);
+        if (!next.mimes[next.count])
+        {
+            _glfwFreeClipboardProvider(&next);
+            _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+            return;
+        }
+    }
+
+    // The platform may still be sending the previous contents, so they are
+    // only freed once it has taken over the new ones
+    previous = _glfw.clipboardProvider;
+    _glfw.clipboardProvider = next;
+    _glfwPlatformSetClipboardProvider();
+    _glfwFreeClipboardProvider(&previous);
 }
 
 GLFWAPI const char* glfwGetClipboardString(GLFWwindow* handle)
@@ -1375,6 +2201,93 @@ GLFWAPI const char* glfwGetClipboardString(GLFWwindow* handle)
     return _glfwPlatformGetClipboardString();
 }
 
+GLFWAPI int glfwGetClipboardData(GLFWwindow* handle, GLFWclipboarddatafun callback, void* user_data)
+{
+    assert(callback != NULL);
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(GLFW_FALSE);
+    return _glfwPlatformGetClipboardData(callback, user_data);
+}
+
+GLFWAPI int glfwRequestClipboard(GLFWwindow* handle, const char* mime,
+                                 GLFWclipboardrequestfun callback,
+                                 void* user_data)
+{
+    _GLFWwindow* window = (_GLFWwindow*) handle;
+    _GLFWclipboardrequest* request;
+    _GLFWclipboardrequest** tail;
+
+    assert(window != NULL);
+    assert(callback != NULL);
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(GLFW_FALSE);
+
+    if (!mime)
+        mime = "text/plain;charset=utf-8";
+
+    request = calloc(1, sizeof(_GLFWclipboardrequest));
+    if (!request)
+    {
+        _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+        return GLFW_FALSE;
+    }
+
+    request->window = window;
+    request->mime = _glfw_strdup(mime);
+    if (!request->mime)
+    {
+        free(request);
+        _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+        return GLFW_FALSE;
+    }
+
+    request->callback = callback;
+    request->userData = user_data;
+    request->fd = -1;
+
+    // Requests are kept in the order they were made
+    tail = &_glfw.clipboardRequestListHead;
+    while (*tail)
+        tail = &((*tail)->next);
+    *tail = request;
+
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+    if (!_glfwPlatformRequestClipboard(request))
+    {
+        request->callback = NULL;
+        _glfwInputClipboardRequestDone(request, GLFW_FALSE);
+        return GLFW_FALSE;
+    }
+#else
+    {
+        const char* string = NULL;
+
+        if (_glfwIsTextMime(mime))
+        {
+            string = _glfwPlatformGetClipboardString();
+        }
+        else
+        {
+            _glfwInputError(GLFW_FORMAT_UNAVAILABLE,
+                            "Clipboard contents cannot be requested as %s",
+                            mime);
+        }
+
+        if (!string ||
+            !_glfwInputClipboardRequestData(request, string, strlen(string)))
+        {
+            request->callback = NULL;
+            _glfwInputClipboardRequestDone(request, GLFW_FALSE);
+            return GLFW_FALSE;
+        }
+
+        _glfwInputClipboardRequestDone(request, GLFW_TRUE);
+    }
+#endif
+
+    return GLFW_TRUE;
+}
+
 GLFWAPI double glfwGetTime(void)
 {
     _GLFW_REQUIRE_INIT_OR_RETURN(0.0);
@@ -1394,6 +2307,15 @@ GLFWAPI void glfwSetTime(double time)
 
     _glfw.timer.offset = _glfwPlatformGetTimerValue() -
         (uint64_t) (time * _glfwPlatformGetTimerFrequency());
+
+    // Window system timestamps need to be mapped onto the new clock
+    _glfw.eventTime.hasServerOffset = GLFW_FALSE;
+}
+
+GLFWAPI double glfwGetEventTime(void)
+{
+    _GLFW_REQUIRE_INIT_OR_RETURN(0.0);
+    return eventTime();
 }
 
 GLFWAPI uint64_t glfwGetTimerValue(void)
@@ -70,7 +70,11 @@ typedef struct _GLFWctxconfig   _GLFWctxconfig;
 typedef struct _GLFWfbconfig    _GLFWfbconfig;
 typedef struct _GLFWcontext     _GLFWcontext;
 typedef struct _GLFWwindow      _GLFWwindow;
+typedef struct _GLFWbatchedEvent _GLFWbatchedEvent;
 typedef struct _GLFWlibrary     _GLFWlibrary;
+typedef struct _GLFWwindowmap   _GLFWwindowmap;
+typedef struct _GLFWclipboardrequest _GLFWclipboardrequest;
+typedef struct _GLFWclipboardprovider _GLFWclipboardprovider;
 typedef struct _GLFWmonitor     _GLFWmonitor;
 typedef struct _GLFWcursor      _GLFWcursor;
 typedef struct _GLFWmapelement  _GLFWmapelement;
@@ -183,6 +187,19 @@ typedef void (APIENTRY * PFN_vkVoidFunction)(void);
   #define vkGetInstanceProcAddr _glfw.vk.GetInstanceProcAddr
 #endif
 
+// Hash table from non-zero 64-bit keys to windows, using linear probing
+// This is defined before the platform headers so that they can embed maps
+//
+struct _GLFWwindowmap
+{
+    struct {
+        uint64_t        key;
+        _GLFWwindow*    window;
+    }*                  slots;
+    size_t              count;
+    size_t              capacity;
+};
+
 #if defined(_GLFW_COCOA)
  #include "cocoa_platform.h"
 #elif defined(_GLFW_WIN32)
@@ -371,6 +388,15 @@ struct _GLFWcontext
     _GLFW_OSMESA_CONTEXT_STATE;
 };
 
+// Input event queued for batched delivery
+//
+struct _GLFWbatchedEvent
+{
+    GLFWevent           event;
+    // Offset of the text of key events in the window text buffer
+    size_t              textOffset;
+};
+
 // Window and context structure
 //
 struct _GLFWwindow
@@ -384,6 +410,10 @@ struct _GLFWwindow
     GLFWbool            floating;
     GLFWbool            focusOnShow;
     GLFWbool            shouldClose;
+    GLFWbool            iconified;
+    // Whether a frame ready callback has been requested but not yet delivered,
+    // on platforms without frame callbacks of their own
+    GLFWbool            frameRequested;
     void*               userPointer;
     GLFWid              id;
     GLFWvidmode         videoMode;
@@ -403,6 +433,35 @@ struct _GLFWwindow
     // Virtual cursor position when cursor is disabled
     double              virtualCursorPosX, virtualCursorPosY;
 
+    // Input events queued while GLFW_EVENT_BATCHING is enabled. Events
+    // [head, head + count) are pending, text holds the text of key events,
+    // of which the text from textHead on is pending.
+    struct {
+        GLFWbool        enabled;
+        _GLFWbatchedEvent* events;
+        size_t          head, count, capacity;
+        char*           text;
+        size_t          textHead, textSize, textCapacity;
+    } batch;
+
+    // Cursor motion coalesced while GLFW_COALESCE_MOTION is enabled. The
+    // history holds the x, y pairs of the most recent coalesced motion.
+    struct {
+        GLFWbool        enabled;
+        GLFWbool        pending;
+        double          time;
+        double*         history;
+        int             historyCount, historyCapacity;
+    } motion;
+
+    // Timings recorded while GLFW_INSTRUMENTATION is enabled
+    struct {
+        GLFWbool        enabled;
+        GLFWhistogram   latency;
+        GLFWhistogram   callback;
+        GLFWhistogram   swap;
+    } timings;
+
     _GLFWcontext        context;
 
     struct {
@@ -415,6 +474,8 @@ struct _GLFWwindow
         GLFWwindowmaximizefun   maximize;
         GLFWframebuffersizefun  fbsize;
         GLFWwindowcontentscalefun scale;
+        GLFWframereadyfun       frameReady;
+        GLFWframepresentedfun   framePresented;
         GLFWmousebuttonfun      mouseButton;
         GLFWcursorposfun        cursorPos;
         GLFWcursorenterfun      cursorEnter;
@@ -517,6 +578,44 @@ struct _GLFWmutex
     _GLFW_PLATFORM_MUTEX_STATE;
 };
 
+// Asynchronous clipboard request, see glfwRequestClipboard
+//
+struct _GLFWclipboardrequest
+{
+    _GLFWclipboardrequest*  next;
+    _GLFWwindow*            window;
+    char*                   mime;
+    GLFWclipboardrequestfun callback;
+    void*                   userData;
+    char*                   data;
+    size_t                  size;
+    size_t                  capacity;
+
+    // State of the transfer, owned by the platform and released along with
+    // the request
+    int                     fd;
+    unsigned long           target;
+    GLFWbool                incremental;
+    unsigned long long      watch;
+    unsigned long long      timer;
+};
+
+// Clipboard contents offered with glfwSetClipboardProvider, each type
+// converted by the provider the first time it is requested
+//
+struct _GLFWclipboardprovider
+{
+    char**                  mimes;
+    int                     count;
+    GLFWclipboardproviderfun provider;
+    void*                   userData;
+    struct {
+        char*               data;
+        size_t              size;
+        GLFWbool            provided;
+    }*                      cache;
+};
+
 // Library global data
 //
 struct _GLFWlibrary
@@ -534,7 +633,10 @@ struct _GLFWlibrary
     _GLFWerror*         errorListHead;
     _GLFWcursor*        cursorListHead;
     _GLFWwindow*        windowListHead;
-    GLFWid              focusedWindowId;
+    _GLFWwindowmap      windowsById;
+    _GLFWwindow*        focusedWindow;
+    _GLFWclipboardrequest* clipboardRequestListHead;
+    _GLFWclipboardprovider clipboardProvider;
 
     _GLFWmonitor**      monitors;
     int                 monitorCount;
@@ -553,6 +655,27 @@ struct _GLFWlibrary
         _GLFW_PLATFORM_LIBRARY_TIMER_STATE;
     } timer;
 
+    // Time of the input event being reported, on the glfwGetTime clock, or
+    // zero if unknown. Window system timestamps are 32-bit milliseconds on
+    // an unspecified clock and are mapped onto it with serverOffset.
+    struct {
+        double          time;
+        GLFWbool        hasServerOffset;
+        double          serverOffset;
+        uint32_t        lastServerTime;
+        uint64_t        serverTimeHigh;
+    } eventTime;
+
+    // Input events reported by the current call to an event processing
+    // function, and totals over all calls
+    struct {
+        GLFWbool        processing;
+        unsigned long long pending;
+        unsigned long long dispatches;
+        unsigned long long events;
+        unsigned long long maxEventsPerDispatch;
+    } eventStats;
+
     struct {
         GLFWbool        available;
         void*           handle;
@@ -629,6 +752,11 @@ void _glfwPlatformSetGammaRamp(_GLFWmonitor* monitor, const GLFWgammaramp* ramp)
 
 void _glfwPlatformSetClipboardString(const char* string);
 const char* _glfwPlatformGetClipboardString(void);
+GLFWbool _glfwPlatformGetClipboardData(GLFWclipboarddatafun callback, void* user_data);
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+GLFWbool _glfwPlatformRequestClipboard(_GLFWclipboardrequest* request);
+#endif
+void _glfwPlatformSetClipboardProvider(void);
 
 int _glfwPlatformPollJoystick(_GLFWjoystick* js, int mode);
 void _glfwPlatformUpdateGamepadGUID(char* guid);
@@ -681,6 +809,8 @@ void _glfwPlatformSetWindowDecorated(_GLFWwindow* window, GLFWbool enabled);
 void _glfwPlatformSetWindowFloating(_GLFWwindow* window, GLFWbool enabled);
 void _glfwPlatformSetWindowOpacity(_GLFWwindow* window, float opacity);
 void _glfwPlatformUpdateIMEState(_GLFWwindow *w, int which, int a, int b, int c, int d);
+void _glfwPlatformRequestWindowFrame(_GLFWwindow* window);
+void _glfwPlatformPrepareFramePresentation(_GLFWwindow* window);
 
 void _glfwPlatformPollEvents(void);
 void _glfwPlatformWaitEvents(void);
@@ -720,6 +850,8 @@ void _glfwInputWindowContentScale(_GLFWwindow* window,
 void _glfwInputWindowIconify(_GLFWwindow* window, GLFWbool iconified);
 void _glfwInputWindowMaximize(_GLFWwindow* window, GLFWbool maximized);
 void _glfwInputWindowDamage(_GLFWwindow* window);
+void _glfwInputFrameReady(_GLFWwindow* window);
+void _glfwInputFramePresented(_GLFWwindow* window, double time, double refresh, int flags);
 void _glfwInputWindowCloseRequest(_GLFWwindow* window);
 void _glfwInputWindowMonitor(_GLFWwindow* window, _GLFWmonitor* monitor);
 
@@ -729,6 +861,16 @@ void _glfwInputMouseClick(_GLFWwindow* window, int button, int action, int mods)
 void _glfwInputCursorPos(_GLFWwindow* window, double xpos, double ypos);
 void _glfwInputCursorEnter(_GLFWwindow* window, GLFWbool entered);
 void _glfwInputDrop(_GLFWwindow* window, int count, const char** names);
+void _glfwFreeEventBatch(_GLFWwindow* window);
+void _glfwInputBeginEvents(void);
+void _glfwInputEndEvents(void);
+void _glfwInputSwapDuration(_GLFWwindow* window, double duration);
+void _glfwInputEventTime(double time);
+void _glfwInputEventTimestamp(uint32_t milliseconds);
+GLFWbool _glfwInputClipboardRequestData(_GLFWclipboardrequest* request, const char* data, size_t size);
+void _glfwInputClipboardRequestDone(_GLFWclipboardrequest* request, GLFWbool succeeded);
+void _glfwCancelClipboardRequests(_GLFWwindow* window);
+void _glfwFreeClipboardRequests(void);
 void _glfwInputJoystick(_GLFWjoystick* js, int event);
 void _glfwInputJoystickAxis(_GLFWjoystick* js, int axis, float value);
 void _glfwInputJoystickButton(_GLFWjoystick* js, int button, char value);
@@ -772,6 +914,10 @@ _GLFWjoystick* _glfwAllocJoystick(const char* name,
                                   int buttonCount,
                                   int hatCount);
 void _glfwFreeJoystick(_GLFWjoystick* js);
+GLFWbool _glfwIsTextMime(const char* mime);
+int _glfwFindClipboardProviderMime(const char* mime);
+const char* _glfwGetClipboardProviderData(const char* mime, size_t* size);
+void _glfwFreeClipboardProvider(_GLFWclipboardprovider* provider);
 const char* _glfwGetKeyName(int key);
 
 GLFWbool _glfwInitVulkan(int mode);
@@ -779,5 +925,9 @@ void _glfwTerminateVulkan(void);
 const char* _glfwGetVulkanResultString(VkResult result);
 _GLFWwindow* _glfwFocusedWindow();
 _GLFWwindow* _glfwWindowForId(GLFWid id);
+GLFWbool _glfwWindowMapInsert(_GLFWwindowmap* map, uint64_t key, _GLFWwindow* window);
+void _glfwWindowMapRemove(_GLFWwindowmap* map, uint64_t key);
+_GLFWwindow* _glfwWindowMapFind(const _GLFWwindowmap* map, uint64_t key);
+void _glfwWindowMapFree(_GLFWwindowmap* map);
 
 char* _glfw_strdup(const char* source);
@@ -196,6 +196,15 @@ void _glfwPlatformSetWindowOpacity(_GLFWwindow* window, float opacity)
 {
 }
 
+void _glfwPlatformRequestWindowFrame(_GLFWwindow* window)
+{
+    window->frameRequested = GLFW_TRUE;
+}
+
+void _glfwPlatformPrepareFramePresentation(_GLFWwindow* window)
+{
+}
+
 void _glfwPlatformShowWindow(_GLFWwindow* window)
 {
 }
@@ -294,6 +303,15 @@ const char* _glfwPlatformGetClipboardString(void)
     return NULL;
 }
 
+GLFWbool _glfwPlatformGetClipboardData(GLFWclipboarddatafun callback, void* user_data)
+{
+    return GLFW_FALSE;
+}
+
+void _glfwPlatformSetClipboardProvider(void)
+{
+}
+
 const char* _glfwPlatformGetScancodeName(int scancode)
 {
     return "";
@@ -0,0 +1,301 @@
+//========================================================================
+// GLFW 3.3 - www.glfw.org
+//------------------------------------------------------------------------
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+#include "pixel_convert.h"
+
+#include <limits.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define HAS_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HAS_NEON_KERNELS
+#include <arm_neon.h>
+#endif
+
+// The vector kernels for _NET_WM_ICON widen each pixel to 64 bits
+#if LONG_MAX > 2147483647L
+#define LONG_IS_64_BITS
+#endif
+
+typedef void (*premultiply_func)(uint8_t *dst, const uint8_t *rgba, size_t count);
+typedef void (*long_func)(long *dst, const uint8_t *rgba, size_t count);
+
+// Scalar reference {{{
+
+static void
+premultiply_scalar(uint8_t *dst, const uint8_t *src, size_t count) {
+    for (; count; count--, src += 4, dst += 4) {
+        const unsigned int alpha = src[3];
+        dst[0] = (src[2] * alpha) / 255;
+        dst[1] = (src[1] * alpha) / 255;
+        dst[2] = (src[0] * alpha) / 255;
+        dst[3] = alpha;
+    }
+}
+
+static void
+long_scalar(long *dst, const uint8_t *src, size_t count) {
+    for (; count; count--, src += 4) {
+        *dst++ = (long) ((uint32_t) src[3] << 24 | (uint32_t) src[0] << 16 |
+                         (uint32_t) src[1] << 8 | src[2]);
+    }
+}
+// }}}
+
+#ifdef HAS_X86_KERNELS
+// SSE2 and AVX2 {{{
+
+// floor(x / 255) is (x * 0x8081) >> 23 for every 16 bit x, which is an
+// unsigned high multiply followed by a shift. Alpha is multiplied by 255
+// instead of by itself, so that it is left unchanged.
+
+static inline __m128i
+premultiply_sse2_half(__m128i px, __m128i alpha_mask, __m128i alpha_one, __m128i divisor) {
+    // R G B A R G B A in 16 bit lanes
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm_or_si128(_mm_andnot_si128(alpha_mask, alpha), alpha_one);
+    px = _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(px, alpha), divisor), 7);
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+static void
+premultiply_sse2(uint8_t *dst, const uint8_t *src, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha_mask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    const __m128i alpha_one = _mm_and_si128(alpha_mask, _mm_set1_epi16(255));
+    const __m128i divisor = _mm_set1_epi16((short) 0x8081);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i px = _mm_loadu_si128((const __m128i*) (src + i * 4));
+        const __m128i lo = premultiply_sse2_half(_mm_unpacklo_epi8(px, zero), alpha_mask, alpha_one, divisor);
+        const __m128i hi = premultiply_sse2_half(_mm_unpackhi_epi8(px, zero), alpha_mask, alpha_one, divisor);
+        _mm_storeu_si128((__m128i*) (dst + i * 4), _mm_packus_epi16(lo, hi));
+    }
+    premultiply_scalar(dst + i * 4, src + i * 4, count - i);
+}
+
+#ifdef LONG_IS_64_BITS
+static void
+long_sse2(long *dst, const uint8_t *src, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i px = _mm_loadu_si128((const __m128i*) (src + i * 4));
+        const __m128i lo = _mm_unpacklo_epi8(px, zero), hi = _mm_unpackhi_epi8(px, zero);
+        const __m128i argb = _mm_packus_epi16(
+            _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2)),
+            _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2)));
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_unpacklo_epi32(argb, zero));
+        _mm_storeu_si128((__m128i*) (dst + i + 2), _mm_unpackhi_epi32(argb, zero));
+    }
+    long_scalar(dst + i, src + i * 4, count - i);
+}
+#else
+#define long_sse2 long_scalar
+#endif
+
+__attribute__((target("avx2"))) static inline __m256i
+premultiply_avx2_half(__m256i px, __m256i alpha_mask, __m256i alpha_one, __m256i divisor) {
+    __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm256_or_si256(_mm256_andnot_si256(alpha_mask, alpha), alpha_one);
+    px = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_mullo_epi16(px, alpha), divisor), 7);
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(px, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+// The unpacks and the pack work within 128 bit lanes, so the pixels come out
+// in the order they went in
+__attribute__((target("avx2"))) static void
+premultiply_avx2(uint8_t *dst, const uint8_t *src, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha_mask = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+    const __m256i alpha_one = _mm256_and_si256(alpha_mask, _mm256_set1_epi16(255));
+    const __m256i divisor = _mm256_set1_epi16((short) 0x8081);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i px = _mm256_loadu_si256((const __m256i*) (src + i * 4));
+        const __m256i lo = premultiply_avx2_half(_mm256_unpacklo_epi8(px, zero), alpha_mask, alpha_one, divisor);
+        const __m256i hi = premultiply_avx2_half(_mm256_unpackhi_epi8(px, zero), alpha_mask, alpha_one, divisor);
+        _mm256_storeu_si256((__m256i*) (dst + i * 4), _mm256_packus_epi16(lo, hi));
+    }
+    premultiply_scalar(dst + i * 4, src + i * 4, count - i);
+}
+
+#ifdef LONG_IS_64_BITS
+__attribute__((target("avx2"))) static void
+long_avx2(long *dst, const uint8_t *src, size_t count) {
+    const __m256i swap = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i argb = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*) (src + i * 4)), swap);
+        _mm256_storeu_si256((__m256i*) (dst + i), _mm256_cvtepu32_epi64(_mm256_castsi256_si128(argb)));
+        _mm256_storeu_si256((__m256i*) (dst + i + 4), _mm256_cvtepu32_epi64(_mm256_extracti128_si256(argb, 1)));
+    }
+    long_scalar(dst + i, src + i * 4, count - i);
+}
+#else
+#define long_avx2 long_scalar
+#endif
+// }}}
+#endif
+
+#ifdef HAS_NEON_KERNELS
+// NEON {{{
+
+// floor(x / 255) is (x + 1 + (x >> 8)) >> 8 for x <= 255 * 255
+static inline uint8x8_t
+div255_neon(uint16x8_t x) {
+    return vshrn_n_u16(vaddq_u16(vaddq_u16(x, vdupq_n_u16(1)), vshrq_n_u16(x, 8)), 8);
+}
+
+static inline uint8x16_t
+premultiply_channel_neon(uint8x16_t c, uint8x16_t a) {
+    return vcombine_u8(div255_neon(vmull_u8(vget_low_u8(c), vget_low_u8(a))),
+                       div255_neon(vmull_u8(vget_high_u8(c), vget_high_u8(a))));
+}
+
+static void
+premultiply_neon(uint8_t *dst, const uint8_t *src, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16x4_t px = vld4q_u8(src + i * 4);
+        uint8x16x4_t out;
+        out.val[0] = premultiply_channel_neon(px.val[2], px.val[3]);
+        out.val[1] = premultiply_channel_neon(px.val[1], px.val[3]);
+        out.val[2] = premultiply_channel_neon(px.val[0], px.val[3]);
+        out.val[3] = px.val[3];
+        vst4q_u8(dst + i * 4, out);
+    }
+    premultiply_scalar(dst + i * 4, src + i * 4, count - i);
+}
+
+#ifdef LONG_IS_64_BITS
+static void
+long_neon(long *dst, const uint8_t *src, size_t count) {
+    static const uint8_t swap_indices[16] = {2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15};
+    const uint8x16_t swap = vld1q_u8(swap_indices);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const uint32x4_t argb = vreinterpretq_u32_u8(vqtbl1q_u8(vld1q_u8(src + i * 4), swap));
+        vst1q_u64((uint64_t*) (dst + i), vmovl_u32(vget_low_u32(argb)));
+        vst1q_u64((uint64_t*) (dst + i + 2), vmovl_high_u32(argb));
+    }
+    long_scalar(dst + i, src + i * 4, count - i);
+}
+#else
+#define long_neon long_scalar
+#endif
+// }}}
+#endif
+
+static const struct {
+    const char *name;
+    premultiply_func premultiply;
+    long_func to_long;
+} kernels[PIXEL_KERNEL_COUNT] = {
+    [PIXEL_KERNEL_SCALAR] = {"scalar", premultiply_scalar, long_scalar},
+#ifdef HAS_X86_KERNELS
+    [PIXEL_KERNEL_SSE2] = {"SSE2", premultiply_sse2, long_sse2},
+    [PIXEL_KERNEL_AVX2] = {"AVX2", premultiply_avx2, long_avx2},
+#else
+    [PIXEL_KERNEL_SSE2] = {"SSE2", NULL, NULL},
+    [PIXEL_KERNEL_AVX2] = {"AVX2", NULL, NULL},
+#endif
+#ifdef HAS_NEON_KERNELS
+    [PIXEL_KERNEL_NEON] = {"NEON", premultiply_neon, long_neon},
+#else
+    [PIXEL_KERNEL_NEON] = {"NEON", NULL, NULL},
+#endif
+};
+
+// Selected the first time a conversion is made
+static PixelKernel active_kernel = PIXEL_KERNEL_COUNT;
+
+static int
+is_supported(PixelKernel kernel) {
+    if (kernel >= PIXEL_KERNEL_COUNT || !kernels[kernel].premultiply) return 0;
+#ifdef HAS_X86_KERNELS
+    if (kernel == PIXEL_KERNEL_AVX2) {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+    return 1;
+}
+
+PixelKernel
+bestPixelKernel(void) {
+    static const PixelKernel preferred[] = {PIXEL_KERNEL_AVX2, PIXEL_KERNEL_SSE2, PIXEL_KERNEL_NEON};
+    for (size_t i = 0; i < sizeof(preferred) / sizeof(preferred[0]); i++) {
+        if (is_supported(preferred[i])) return preferred[i];
+    }
+    return PIXEL_KERNEL_SCALAR;
+}
+
+int
+usePixelKernel(PixelKernel kernel) {
+    if (!is_supported(kernel)) return 0;
+    active_kernel = kernel;
+    return 1;
+}
+
+const char*
+pixelKernelName(PixelKernel kernel) {
+    return kernel < PIXEL_KERNEL_COUNT ? kernels[kernel].name : "unknown";
+}
+
+static PixelKernel
+current_kernel(void) {
+    if (active_kernel == PIXEL_KERNEL_COUNT) active_kernel = bestPixelKernel();
+    return active_kernel;
+}
+
+void
+premultiplyToBGRA(uint8_t *dst, const uint8_t *rgba, size_t count) {
+    kernels[current_kernel()].premultiply(dst, rgba, count);
+}
+
+void
+premultiplyToARGB32(uint32_t *dst, const uint8_t *rgba, size_t count) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // B, G, R, A bytes are A << 24 | R << 16 | G << 8 | B in memory
+    premultiplyToBGRA((uint8_t*) dst, rgba, count);
+#else
+    for (; count; count--, rgba += 4) {
+        const unsigned int alpha = rgba[3];
+        *dst++ = alpha << 24 | (rgba[0] * alpha) / 255 << 16 |
+                 (rgba[1] * alpha) / 255 << 8 | (rgba[2] * alpha) / 255;
+    }
+#endif
+}
+
+void
+convertToARGB32Long(long *dst, const uint8_t *rgba, size_t count) {
+    kernels[current_kernel()].to_long(dst, rgba, count);
+}
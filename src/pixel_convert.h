@@ -0,0 +1,57 @@
+//========================================================================
+// GLFW 3.3 - www.glfw.org
+//------------------------------------------------------------------------
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Converts the RGBA pixels of GLFWimage into the formats used by the window
+// systems for cursors and icons. The vector kernels give exactly the same
+// results as the scalar one, and the best one the CPU supports is picked
+// the first time a conversion is made.
+
+typedef enum {
+    PIXEL_KERNEL_SCALAR,
+    PIXEL_KERNEL_SSE2,
+    PIXEL_KERNEL_AVX2,
+    PIXEL_KERNEL_NEON,
+    PIXEL_KERNEL_COUNT
+} PixelKernel;
+
+// Writes B, G, R, A bytes with the color channels premultiplied by alpha,
+// which is WL_SHM_FORMAT_ARGB8888
+void premultiplyToBGRA(uint8_t *dst, const uint8_t *rgba, size_t count);
+// Writes A << 24 | R << 16 | G << 8 | B with the color channels premultiplied
+// by alpha, which is an XcursorPixel
+void premultiplyToARGB32(uint32_t *dst, const uint8_t *rgba, size_t count);
+// Writes A << 24 | R << 16 | G << 8 | B without premultiplying, as one long
+// per pixel, which is the layout of _NET_WM_ICON
+void convertToARGB32Long(long *dst, const uint8_t *rgba, size_t count);
+
+PixelKernel bestPixelKernel(void);
+// Makes the conversions use the specified kernel, returning zero if the CPU
+// does not support it
+int usePixelKernel(PixelKernel kernel);
+const char* pixelKernelName(PixelKernel kernel);
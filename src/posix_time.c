@@ -56,6 +56,22 @@ void _glfwInitTimerPOSIX(void)
 }
 
 
+// Converts a time point, in seconds, of the specified clock to the timeline of
+// glfwGetTime
+//
+double _glfwTimeFromClockPOSIX(clockid_t clock, double seconds)
+{
+    struct timespec ts;
+    const double now = (double) (_glfwPlatformGetTimerValue() - _glfw.timer.offset) /
+        _glfwPlatformGetTimerFrequency();
+
+    if (clock_gettime(clock, &ts) != 0)
+        return now;
+
+    return now - ((double) ts.tv_sec + ts.tv_nsec / 1e9 - seconds);
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 //////                       GLFW platform API                      //////
 //////////////////////////////////////////////////////////////////////////
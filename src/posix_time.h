@@ -28,6 +28,7 @@
 #define _GLFW_PLATFORM_LIBRARY_TIMER_STATE _GLFWtimerPOSIX posix
 
 #include <stdint.h>
+#include <time.h>
 
 
 // POSIX-specific global timer data
@@ -41,4 +42,5 @@ typedef struct _GLFWtimerPOSIX
 
 
 void _glfwInitTimerPOSIX(void);
+double _glfwTimeFromClockPOSIX(clockid_t clock, double seconds);
 
@@ -1842,6 +1842,15 @@ void _glfwPlatformSetWindowOpacity(_GLFWwindow* window, float opacity)
     }
 }
 
+void _glfwPlatformRequestWindowFrame(_GLFWwindow* window)
+{
+    window->frameRequested = GLFW_TRUE;
+}
+
+void _glfwPlatformPrepareFramePresentation(_GLFWwindow* window)
+{
+}
+
 void _glfwPlatformPollEvents(void)
 {
     MSG msg;
@@ -2118,6 +2127,75 @@ const char* _glfwPlatformGetClipboardString(void)
     return _glfw.win32.clipboardString;
 }
 
+GLFWbool _glfwPlatformGetClipboardData(GLFWclipboarddatafun callback, void* user_data)
+{
+    HANDLE object;
+    WCHAR* buffer;
+    char* data;
+    int length, size;
+
+    if (!OpenClipboard(_glfw.win32.helperWindowHandle))
+    {
+        _glfwInputErrorWin32(GLFW_PLATFORM_ERROR,
+                             "Win32: Failed to open clipboard");
+        return GLFW_FALSE;
+    }
+
+    object = GetClipboardData(CF_UNICODETEXT);
+    if (!object)
+    {
+        _glfwInputErrorWin32(GLFW_FORMAT_UNAVAILABLE,
+                             "Win32: Failed to convert clipboard to string");
+        CloseClipboard();
+        return GLFW_FALSE;
+    }
+
+    buffer = GlobalLock(object);
+    if (!buffer)
+    {
+        _glfwInputErrorWin32(GLFW_PLATFORM_ERROR,
+                             "Win32: Failed to lock global handle");
+        CloseClipboard();
+        return GLFW_FALSE;
+    }
+
+    // The size of the global memory object may be larger than the text, so
+    // the text ends at the first terminator within it
+    length = (int) (GlobalSize(object) / sizeof(WCHAR));
+    length = (int) wcsnlen(buffer, length);
+
+    size = WideCharToMultiByte(CP_UTF8, 0, buffer, length, NULL, 0, NULL, NULL);
+    data = calloc(size + 1, 1);
+    if (size && !WideCharToMultiByte(CP_UTF8, 0, buffer, length, data, size, NULL, NULL))
+    {
+        _glfwInputErrorWin32(GLFW_PLATFORM_ERROR,
+                             "Win32: Failed to convert clipboard string to UTF-8");
+        free(data);
+        GlobalUnlock(object);
+        CloseClipboard();
+        return GLFW_FALSE;
+    }
+
+    GlobalUnlock(object);
+    CloseClipboard();
+
+    callback(data, size, user_data);
+    free(data);
+    return GLFW_TRUE;
+}
+
+void _glfwPlatformSetClipboardProvider(void)
+{
+    size_t size;
+    const char* text = _glfwGetClipboardProviderData("text/plain;charset=utf-8", &size);
+
+    // Only text can be put on the clipboard, so the provider is not kept
+    if (text)
+        _glfwPlatformSetClipboardString(text);
+
+    _glfwFreeClipboardProvider(&_glfw.clipboardProvider);
+}
+
 void _glfwPlatformGetRequiredInstanceExtensions(char** extensions)
 {
     if (!_glfw.vk.KHR_surface || !_glfw.vk.KHR_win32_surface)
@@ -48,7 +48,9 @@ void _glfwInputWindowFocus(_GLFWwindow* window, GLFWbool focused)
     if (!focused)
     {
         int key, button;
-        _glfw.focusedWindowId = 0;
+
+        if (_glfw.focusedWindow == window)
+            _glfw.focusedWindow = NULL;
 
         for (key = 0;  key <= GLFW_KEY_LAST;  key++)
         {
@@ -65,27 +67,7 @@ void _glfwInputWindowFocus(_GLFWwindow* window, GLFWbool focused)
                 _glfwInputMouseClick(window, button, GLFW_RELEASE, 0);
         }
     } else
-        _glfw.focusedWindowId = window->id;
-}
-
-_GLFWwindow* _glfwFocusedWindow() {
-    if (_glfw.focusedWindowId) {
-        _GLFWwindow *w = _glfw.windowListHead;
-        while (w) {
-            if (w->id == _glfw.focusedWindowId) return w;
-            w = w->next;
-        }
-    }
-    return NULL;
-}
-
-_GLFWwindow* _glfwWindowForId(GLFWid id) {
-    _GLFWwindow *w = _glfw.windowListHead;
-    while (w) {
-        if (w->id == _glfw.focusedWindowId) return w;
-        w = w->next;
-    }
-    return NULL;
+        _glfw.focusedWindow = window;
 }
 
 // Notifies shared code that a window has moved
@@ -110,6 +92,7 @@ void _glfwInputWindowSize(_GLFWwindow* window, int width, int height)
 //
 void _glfwInputWindowIconify(_GLFWwindow* window, GLFWbool iconified)
 {
+    window->iconified = iconified;
     if (window->callbacks.iconify)
         window->callbacks.iconify((GLFWwindow*) window, iconified);
 }
@@ -148,6 +131,22 @@ void _glfwInputWindowDamage(_GLFWwindow* window)
         window->callbacks.refresh((GLFWwindow*) window);
 }
 
+// Notifies shared code that it is a good time to draw a new frame of a window
+//
+void _glfwInputFrameReady(_GLFWwindow* window)
+{
+    if (window->callbacks.frameReady)
+        window->callbacks.frameReady((GLFWwindow*) window);
+}
+
+// Notifies shared code that a frame of a window has been shown on the display
+//
+void _glfwInputFramePresented(_GLFWwindow* window, double time, double refresh, int flags)
+{
+    if (window->callbacks.framePresented)
+        window->callbacks.framePresented((GLFWwindow*) window, time, refresh, flags);
+}
+
 // Notifies shared code that the user wishes to close a window
 //
 void _glfwInputWindowCloseRequest(_GLFWwindow* window)
@@ -166,10 +165,180 @@ void _glfwInputWindowMonitor(_GLFWwindow* window, _GLFWmonitor* monitor)
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+//////                       GLFW internal API                      //////
+//////////////////////////////////////////////////////////////////////////
+
+// Returns the slot the key hashes to
+//
+static size_t windowMapSlot(const _GLFWwindowmap* map, uint64_t key)
+{
+    uint64_t hash = key * 0x9e3779b97f4a7c15ull;
+    hash ^= hash >> 32;
+    return (size_t) hash & (map->capacity - 1);
+}
+
+// Returns the focused window, or NULL if no window has input focus
+//
+_GLFWwindow* _glfwFocusedWindow()
+{
+    return _glfw.focusedWindow;
+}
+
+// Returns the window with the specified id, or NULL if it has been destroyed
+//
+_GLFWwindow* _glfwWindowForId(GLFWid id)
+{
+    return _glfwWindowMapFind(&_glfw.windowsById, id);
+}
+
+// Adds or replaces the window for the specified key
+//
+GLFWbool _glfwWindowMapInsert(_GLFWwindowmap* map, uint64_t key, _GLFWwindow* window)
+{
+    size_t i;
+
+    assert(key != 0);
+
+    // Keep the load factor at or below one half
+    if ((map->count + 1) * 2 > map->capacity)
+    {
+        _GLFWwindowmap grown = { NULL, 0, map->capacity ? map->capacity * 2 : 16 };
+
+        grown.slots = calloc(grown.capacity, sizeof(grown.slots[0]));
+        if (!grown.slots)
+        {
+            _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+            return GLFW_FALSE;
+        }
+
+        for (i = 0;  i < map->capacity;  i++)
+        {
+            if (map->slots[i].key)
+                _glfwWindowMapInsert(&grown, map->slots[i].key, map->slots[i].window);
+        }
+
+        free(map->slots);
+        *map = grown;
+    }
+
+    for (i = windowMapSlot(map, key);  map->slots[i].key;  i = (i + 1) & (map->capacity - 1))
+    {
+        if (map->slots[i].key == key)
+        {
+            map->slots[i].window = window;
+            return GLFW_TRUE;
+        }
+    }
+
+    map->slots[i].key = key;
+    map->slots[i].window = window;
+    map->count++;
+    return GLFW_TRUE;
+}
+
+// Removes the window for the specified key, if any
+//
+void _glfwWindowMapRemove(_GLFWwindowmap* map, uint64_t key)
+{
+    size_t i, j;
+    const size_t mask = map->capacity - 1;
+
+    if (!map->count || !key)
+        return;
+
+    for (i = windowMapSlot(map, key);  map->slots[i].key != key;  i = (i + 1) & mask)
+    {
+        if (!map->slots[i].key)
+            return;
+    }
+
+    // Move back the following entries that would no longer be reachable
+    // across the hole, so that no tombstones are needed
+    for (j = (i + 1) & mask;  map->slots[j].key;  j = (j + 1) & mask)
+    {
+        const size_t home = windowMapSlot(map, map->slots[j].key);
+
+        if (((j - home) & mask) >= ((j - i) & mask))
+        {
+            map->slots[i] = map->slots[j];
+            i = j;
+        }
+    }
+
+    map->slots[i].key = 0;
+    map->slots[i].window = NULL;
+    map->count--;
+}
+
+// Returns the window for the specified key, or NULL if there is none
+//
+_GLFWwindow* _glfwWindowMapFind(const _GLFWwindowmap* map, uint64_t key)
+{
+    size_t i;
+
+    if (!map->count || !key)
+        return NULL;
+
+    for (i = windowMapSlot(map, key);  map->slots[i].key;  i = (i + 1) & (map->capacity - 1))
+    {
+        if (map->slots[i].key == key)
+            return map->slots[i].window;
+    }
+
+    return NULL;
+}
+
+// Frees the slots of the map
+//
+void _glfwWindowMapFree(_GLFWwindowmap* map)
+{
+    free(map->slots);
+    memset(map, 0, sizeof(_GLFWwindowmap));
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 //////                        GLFW public API                       //////
 //////////////////////////////////////////////////////////////////////////
 
+static GLFWid windowIdCounter = 0;
+
+// Returns whether any window has a requested frame that can be delivered
+// without waiting for events
+//
+static GLFWbool framesReady(void)
+{
+    _GLFWwindow* window;
+
+    for (window = _glfw.windowListHead;  window;  window = window->next)
+    {
+        if (window->frameRequested && !window->iconified)
+            return GLFW_TRUE;
+    }
+
+    return GLFW_FALSE;
+}
+
+// Delivers the frames requested on platforms without frame callbacks
+//
+static void inputRequestedFrames(void)
+{
+    _GLFWwindow* window;
+    _GLFWwindow* next;
+
+    for (window = _glfw.windowListHead;  window;  window = next)
+    {
+        // The callback may destroy the window or request another frame
+        next = window->next;
+        if (window->frameRequested && !window->iconified)
+        {
+            window->frameRequested = GLFW_FALSE;
+            _glfwInputFrameReady(window);
+        }
+    }
+}
+
 GLFWAPI GLFWwindow* glfwCreateWindow(int width, int height,
                                      const char* title,
                                      GLFWmonitor* monitor,
@@ -207,12 +376,17 @@ GLFWAPI GLFWwindow* glfwCreateWindow(int width, int height,
     if (!_glfwIsValidContextConfig(&ctxconfig))
         return NULL;
 
-    static GLFWid windowIdCounter = 0;
     window = calloc(1, sizeof(_GLFWwindow));
     window->next = _glfw.windowListHead;
     window->id = ++windowIdCounter;
     _glfw.windowListHead = window;
 
+    if (!_glfwWindowMapInsert(&_glfw.windowsById, window->id, window))
+    {
+        glfwDestroyWindow((GLFWwindow*) window);
+        return NULL;
+    }
+
     window->videoMode.width       = width;
     window->videoMode.height      = height;
     window->videoMode.redBits     = fbconfig.redBits;
@@ -488,6 +662,13 @@ GLFWAPI void glfwDestroyWindow(GLFWwindow* handle)
         glfwMakeContextCurrent(NULL);
 
     _glfwPlatformDestroyWindow(window);
+    _glfwFreeEventBatch(window);
+    _glfwCancelClipboardRequests(window);
+
+    if (_glfw.focusedWindow == window)
+        _glfw.focusedWindow = NULL;
+
+    _glfwWindowMapRemove(&_glfw.windowsById, window->id);
 
     // Unlink window from global linked list
     {
@@ -1107,10 +1288,45 @@ GLFWAPI GLFWwindowcontentscalefun glfwSetWindowContentScaleCallback(GLFWwindow*
     return cbfun;
 }
 
+GLFWAPI GLFWframereadyfun glfwSetWindowFrameReadyCallback(GLFWwindow* handle,
+                                                          GLFWframereadyfun cbfun)
+{
+    _GLFWwindow* window = (_GLFWwindow*) handle;
+    assert(window != NULL);
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(NULL);
+    _GLFW_SWAP_POINTERS(window->callbacks.frameReady, cbfun);
+    return cbfun;
+}
+
+GLFWAPI void glfwRequestWindowFrame(GLFWwindow* handle)
+{
+    _GLFWwindow* window = (_GLFWwindow*) handle;
+    assert(window != NULL);
+
+    _GLFW_REQUIRE_INIT();
+
+    _glfwPlatformRequestWindowFrame(window);
+}
+
+GLFWAPI GLFWframepresentedfun glfwSetWindowFramePresentedCallback(GLFWwindow* handle,
+                                                                  GLFWframepresentedfun cbfun)
+{
+    _GLFWwindow* window = (_GLFWwindow*) handle;
+    assert(window != NULL);
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(NULL);
+    _GLFW_SWAP_POINTERS(window->callbacks.framePresented, cbfun);
+    return cbfun;
+}
+
 GLFWAPI void glfwPollEvents(void)
 {
     _GLFW_REQUIRE_INIT();
+    _glfwInputBeginEvents();
     _glfwPlatformPollEvents();
+    _glfwInputEndEvents();
+    inputRequestedFrames();
 }
 
 GLFWAPI void glfwWaitEvents(void)
@@ -1120,7 +1336,13 @@ GLFWAPI void glfwWaitEvents(void)
     if (!_glfw.windowListHead)
         return;
 
-    _glfwPlatformWaitEvents();
+    _glfwInputBeginEvents();
+    if (framesReady())
+        _glfwPlatformPollEvents();
+    else
+        _glfwPlatformWaitEvents();
+    _glfwInputEndEvents();
+    inputRequestedFrames();
 }
 
 GLFWAPI void glfwWaitEventsTimeout(double timeout)
@@ -1136,7 +1358,13 @@ GLFWAPI void glfwWaitEventsTimeout(double timeout)
         return;
     }
 
-    _glfwPlatformWaitEventsTimeout(timeout);
+    _glfwInputBeginEvents();
+    if (framesReady())
+        _glfwPlatformPollEvents();
+    else
+        _glfwPlatformWaitEventsTimeout(timeout);
+    _glfwInputEndEvents();
+    inputRequestedFrames();
 }
 
 GLFWAPI void glfwPostEmptyEvent(void)
@@ -1148,3 +1376,82 @@ GLFWAPI void glfwPostEmptyEvent(void)
 
     _glfwPlatformPostEmptyEvent();
 }
+
+GLFWAPI unsigned long long glfwAddWatch(int fd, int events, int enabled, GLFWwatchfun callback, void* data)
+{
+    assert(callback != NULL);
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(0);
+
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+    // The GLFW_WATCH_* events have the same values as the poll() events
+    return addWatch(&_GLFW_PLATFORM_EVENT_LOOP_DATA, "application", fd, events, enabled, callback, data);
+#else
+    _glfwInputError(GLFW_PLATFORM_ERROR,
+                    "Event loop watches are not supported on this platform");
+    return 0;
+#endif
+}
+
+GLFWAPI void glfwToggleWatch(unsigned long long watch_id, int enabled)
+{
+    _GLFW_REQUIRE_INIT();
+
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+    toggleWatch(&_GLFW_PLATFORM_EVENT_LOOP_DATA, watch_id, enabled);
+#endif
+}
+
+GLFWAPI void glfwRemoveWatch(unsigned long long watch_id)
+{
+    _GLFW_REQUIRE_INIT();
+
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+    removeWatch(&_GLFW_PLATFORM_EVENT_LOOP_DATA, watch_id);
+#endif
+}
+
+GLFWAPI unsigned long long glfwAddTimer(double interval, int enabled, GLFWtimerfun callback, void* data)
+{
+    assert(callback != NULL);
+    assert(interval >= 0.0);
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(0);
+
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+    return addTimer(&_GLFW_PLATFORM_EVENT_LOOP_DATA, "application", interval, enabled, callback, data);
+#else
+    _glfwInputError(GLFW_PLATFORM_ERROR,
+                    "Event loop timers are not supported on this platform");
+    return 0;
+#endif
+}
+
+GLFWAPI void glfwToggleTimer(unsigned long long timer_id, int enabled)
+{
+    _GLFW_REQUIRE_INIT();
+
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+    toggleTimer(&_GLFW_PLATFORM_EVENT_LOOP_DATA, timer_id, enabled);
+#endif
+}
+
+GLFWAPI void glfwChangeTimerInterval(unsigned long long timer_id, double interval)
+{
+    assert(interval >= 0.0);
+
+    _GLFW_REQUIRE_INIT();
+
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+    changeTimerInterval(&_GLFW_PLATFORM_EVENT_LOOP_DATA, timer_id, interval);
+#endif
+}
+
+GLFWAPI void glfwRemoveTimer(unsigned long long timer_id)
+{
+    _GLFW_REQUIRE_INIT();
+
+#if defined(_GLFW_PLATFORM_EVENT_LOOP_DATA)
+    removeTimer(&_GLFW_PLATFORM_EVENT_LOOP_DATA, timer_id);
+#endif
+}
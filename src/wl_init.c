@@ -103,7 +103,10 @@ static void pointerHandleEnter(void* data,
 
     window->wl.hovered = GLFW_TRUE;
 
+    // The cursor has to be set again with the serial of every enter
+    _glfw.wl.activeCursor.valid = GLFW_FALSE;
     _glfwPlatformSetCursor(window, window->wl.currentCursor);
+    _glfwInputEventTime(0.0);
     _glfwInputCursorEnter(window, GLFW_TRUE);
 }
 
@@ -121,18 +124,18 @@ static void pointerHandleLeave(void* data,
 
     _glfw.wl.pointerSerial = serial;
     _glfw.wl.pointerFocus = NULL;
+    _glfwInputEventTime(0.0);
     _glfwInputCursorEnter(window, GLFW_FALSE);
 }
 
-static void setCursor(const char* name)
+static void setCursor(_GLFWwindow* window, const char* name)
 {
     struct wl_buffer* buffer;
     struct wl_cursor* cursor;
     struct wl_cursor_image* image;
-    struct wl_surface* surface = _glfw.wl.cursorSurface;
+    int scale;
 
-    cursor = wl_cursor_theme_get_cursor(_glfw.wl.cursorTheme,
-                                        name);
+    cursor = _glfwGetThemeCursorWayland(name, window->wl.scale, &scale);
     if (!cursor)
     {
         _glfwInputError(GLFW_PLATFORM_ERROR,
@@ -148,14 +151,10 @@ static void setCursor(const char* name)
     buffer = wl_cursor_image_get_buffer(image);
     if (!buffer)
         return;
-    wl_pointer_set_cursor(_glfw.wl.pointer, _glfw.wl.pointerSerial,
-                          surface,
-                          image->hotspot_x,
-                          image->hotspot_y);
-    wl_surface_attach(surface, buffer, 0, 0);
-    wl_surface_damage(surface, 0, 0,
-                      image->width, image->height);
-    wl_surface_commit(surface);
+    _glfwSetCursorBufferWayland(buffer,
+                                image->width, image->height,
+                                image->hotspot_x, image->hotspot_y,
+                                scale);
 }
 
 static void pointerHandleMotion(void* data,
@@ -181,6 +180,7 @@ static void pointerHandleMotion(void* data,
     switch (window->wl.decorations.focus)
     {
         case mainWindow:
+            _glfwInputEventTimestamp(time);
             _glfwInputCursorPos(window,
                                 wl_fixed_to_double(sx),
                                 wl_fixed_to_double(sy));
@@ -214,7 +214,7 @@ static void pointerHandleMotion(void* data,
         default:
             assert(0);
     }
-    setCursor(cursorName);
+    setCursor(window, cursorName);
 }
 
 static void pointerHandleButton(void* data,
@@ -304,6 +304,7 @@ static void pointerHandleButton(void* data,
      * codes. */
     glfwButton = button - BTN_LEFT;
 
+    _glfwInputEventTimestamp(time);
     _glfwInputMouseClick(window,
                          glfwButton,
                          state == WL_POINTER_BUTTON_STATE_PRESSED
@@ -331,6 +332,7 @@ static void pointerHandleAxis(void* data,
     else if (axis == WL_POINTER_AXIS_VERTICAL_SCROLL)
         y = wl_fixed_to_double(value) * -1;
 
+    _glfwInputEventTimestamp(time);
     _glfwInputScroll(window, x, y, 1);
 }
 
@@ -406,6 +408,7 @@ static void keyboardHandleLeave(void* data,
 static void
 dispatchPendingKeyRepeats(id_type timer_id, void *data) {
     if (_glfw.wl.keyRepeatInfo.keyboardFocus != _glfw.wl.keyboardFocus || _glfw.wl.keyboardRepeatRate == 0) return;
+    _glfwInputEventTime(0.0);
     glfw_xkb_handle_key_event(_glfw.wl.keyRepeatInfo.keyboardFocus, &_glfw.wl.xkb, _glfw.wl.keyRepeatInfo.key, GLFW_REPEAT);
     changeTimerInterval(&_glfw.wl.eventLoopData, _glfw.wl.keyRepeatInfo.keyRepeatTimer, ((double)_glfw.wl.keyboardRepeatRate) / 1000.0);
     toggleTimer(&_glfw.wl.eventLoopData, _glfw.wl.keyRepeatInfo.keyRepeatTimer, 1);
@@ -423,6 +426,7 @@ static void keyboardHandleKey(void* data,
     if (!window)
         return;
     int action = state == WL_KEYBOARD_KEY_STATE_PRESSED ? GLFW_PRESS : GLFW_RELEASE;
+    _glfwInputEventTimestamp(time);
     glfw_xkb_handle_key_event(window, &_glfw.wl.xkb, key, action);
     GLFWbool repeatable = GLFW_FALSE;
 
@@ -519,6 +523,17 @@ static const struct xdg_wm_base_listener wmBaseListener = {
     wmBaseHandlePing
 };
 
+static void presentationHandleClockId(void* data,
+                                      struct wp_presentation* presentation,
+                                      uint32_t clock)
+{
+    _glfw.wl.presentationClock = clock;
+}
+
+static const struct wp_presentation_listener presentationListener = {
+    presentationHandleClockId
+};
+
 static void registryHandleGlobal(void* data,
                                  struct wl_registry* registry,
                                  uint32_t name,
@@ -576,6 +591,14 @@ static void registryHandleGlobal(void* data,
         _glfw.wl.viewporter =
             wl_registry_bind(registry, name, &wp_viewporter_interface, 1);
     }
+    else if (strcmp(interface, "wp_presentation") == 0)
+    {
+        _glfw.wl.presentation =
+            wl_registry_bind(registry, name, &wp_presentation_interface, 1);
+        _glfw.wl.presentationClock = CLOCK_MONOTONIC;
+        wp_presentation_add_listener(_glfw.wl.presentation,
+                                     &presentationListener, NULL);
+    }
     else if (strcmp(interface, "zwp_relative_pointer_manager_v1") == 0)
     {
         _glfw.wl.relativePointerManager =
@@ -641,7 +664,9 @@ static const struct wl_registry_listener registryListener = {
 
 int _glfwPlatformInit(void)
 {
-    if (pipe2(_glfw.wl.eventLoopData.wakeupFds, O_CLOEXEC | O_NONBLOCK) != 0)
+    _glfw.wl.clipboardFd = -1;
+
+    if (!initWakeupFds(&_glfw.wl.eventLoopData))
     {
         _glfwInputError(GLFW_PLATFORM_ERROR,
                 "Wayland: failed to create self pipe");
@@ -714,8 +739,7 @@ int _glfwPlatformInit(void)
 
     if (_glfw.wl.pointer && _glfw.wl.shm)
     {
-        _glfw.wl.cursorTheme = wl_cursor_theme_load(NULL, 32, _glfw.wl.shm);
-        if (!_glfw.wl.cursorTheme)
+        if (!_glfwGetCursorThemeWayland(1))
         {
             _glfwInputError(GLFW_PLATFORM_ERROR,
                             "Wayland: Unable to load default cursor theme");
@@ -743,8 +767,7 @@ void _glfwPlatformTerminate(void)
     glfw_xkb_release(&_glfw.wl.xkb);
     glfw_dbus_terminate(&_glfw.wl.dbus);
 
-    if (_glfw.wl.cursorTheme)
-        wl_cursor_theme_destroy(_glfw.wl.cursorTheme);
+    _glfwTerminateCursorThemesWayland();
     if (_glfw.wl.cursor.handle)
     {
         _glfw_dlclose(_glfw.wl.cursor.handle);
@@ -757,12 +780,15 @@ void _glfwPlatformTerminate(void)
         wl_subcompositor_destroy(_glfw.wl.subcompositor);
     if (_glfw.wl.compositor)
         wl_compositor_destroy(_glfw.wl.compositor);
+    _glfwTerminateShmPoolWayland();
     if (_glfw.wl.shm)
         wl_shm_destroy(_glfw.wl.shm);
     if (_glfw.wl.shell)
         wl_shell_destroy(_glfw.wl.shell);
     if (_glfw.wl.viewporter)
         wp_viewporter_destroy(_glfw.wl.viewporter);
+    if (_glfw.wl.presentation)
+        wp_presentation_destroy(_glfw.wl.presentation);
     if (_glfw.wl.wmBase)
         xdg_wm_base_destroy(_glfw.wl.wmBase);
     if (_glfw.wl.pointer)
@@ -779,11 +805,7 @@ void _glfwPlatformTerminate(void)
         zwp_idle_inhibit_manager_v1_destroy(_glfw.wl.idleInhibitManager);
     if (_glfw.wl.dataSourceForClipboard)
         wl_data_source_destroy(_glfw.wl.dataSourceForClipboard);
-    for (size_t doi=0; doi < arraysz(_glfw.wl.dataOffers); doi++) {
-        if (_glfw.wl.dataOffers[doi].id) {
-            wl_data_offer_destroy(_glfw.wl.dataOffers[doi].id);
-        }
-    }
+    _glfwDestroyDataOffersWayland();
     if (_glfw.wl.dataDevice)
         wl_data_device_destroy(_glfw.wl.dataDevice);
     if (_glfw.wl.dataDeviceManager)
@@ -795,7 +817,9 @@ void _glfwPlatformTerminate(void)
         wl_display_flush(_glfw.wl.display);
         wl_display_disconnect(_glfw.wl.display);
     }
+    _glfwFreeDataTransfersWayland();
     closeFds(_glfw.wl.eventLoopData.wakeupFds, sizeof(_glfw.wl.eventLoopData.wakeupFds)/sizeof(_glfw.wl.eventLoopData.wakeupFds[0]));
+    finalizePollData(&_glfw.wl.eventLoopData);
     free(_glfw.wl.clipboardString); _glfw.wl.clipboardString = NULL;
     free(_glfw.wl.clipboardSourceString); _glfw.wl.clipboardSourceString = NULL;
 
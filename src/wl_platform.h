@@ -56,6 +56,7 @@ typedef VkBool32 (APIENTRY *PFN_vkGetPhysicalDeviceWaylandPresentationSupportKHR
 
 #include "wayland-xdg-shell-client-protocol.h"
 #include "wayland-viewporter-client-protocol.h"
+#include "wayland-presentation-time-client-protocol.h"
 #include "wayland-relative-pointer-unstable-v1-client-protocol.h"
 #include "wayland-pointer-constraints-unstable-v1-client-protocol.h"
 #include "wayland-idle-inhibit-unstable-v1-client-protocol.h"
@@ -71,6 +72,7 @@ typedef VkBool32 (APIENTRY *PFN_vkGetPhysicalDeviceWaylandPresentationSupportKHR
 #define _GLFW_PLATFORM_LIBRARY_WINDOW_STATE _GLFWlibraryWayland wl
 #define _GLFW_PLATFORM_MONITOR_STATE        _GLFWmonitorWayland wl
 #define _GLFW_PLATFORM_CURSOR_STATE         _GLFWcursorWayland  wl
+#define _GLFW_PLATFORM_EVENT_LOOP_DATA      _glfw.wl.eventLoopData
 
 #define _GLFW_PLATFORM_CONTEXT_STATE
 #define _GLFW_PLATFORM_LIBRARY_CONTEXT_STATE
@@ -108,6 +110,9 @@ typedef void (* PFN_wl_egl_window_resize)(struct wl_egl_window*, int, int, int,
 #define _GLFW_DECORATION_VERTICAL (_GLFW_DECORATION_TOP + _GLFW_DECORATION_WIDTH)
 #define _GLFW_DECORATION_HORIZONTAL (2 * _GLFW_DECORATION_WIDTH)
 
+// The cursor size at a buffer scale of 1, in pixels
+#define _GLFW_CURSOR_SIZE 32
+
 typedef enum _GLFWdecorationSideWayland
 {
     mainWindow,
@@ -126,6 +131,19 @@ typedef struct _GLFWdecorationWayland
 
 } _GLFWdecorationWayland;
 
+// A buffer sub-allocated from the shared memory pool, or a free block of it
+//
+typedef struct _GLFWshmbufferWayland
+{
+    struct wl_buffer*           buffer;
+    size_t                      offset, size;
+    int                         width, height;
+    // Whether the buffer is used by a cursor or decoration
+    GLFWbool                    owned;
+    // Whether the compositor may still be reading the buffer
+    GLFWbool                    busy;
+} _GLFWshmbufferWayland;
+
 // Wayland-specific per-window data
 //
 typedef struct _GLFWwindowWayland
@@ -138,7 +156,11 @@ typedef struct _GLFWwindowWayland
     struct wl_surface*          surface;
     struct wl_egl_window*       native;
     struct wl_shell_surface*    shellSurface;
-    struct wl_callback*         callback;
+    // The pending wl_surface.frame request of glfwRequestWindowFrame
+    struct wl_callback*         frameCallback;
+    // Whether a configure has been received that no buffer swap has yet
+    // answered, during which the surface must not be committed on its own
+    GLFWbool                    configurePending;
 
     struct {
         struct xdg_surface*     surface;
@@ -184,11 +206,50 @@ typedef struct _GLFWWaylandDataOffer
     size_t idx;
     int is_self_offer;
     int has_uri_list;
+    // Every MIME type the offer was advertised with
+    char **mimes;
+    size_t mimes_count;
     uint32_t source_actions;
     uint32_t dnd_action;
     struct wl_surface *surface;
 } _GLFWWaylandDataOffer;
 
+// Outgoing transfer of the clipboard to a paste target, written as the
+// target drains its pipe
+//
+typedef struct _GLFWWaylandDataTransfer
+{
+    struct _GLFWWaylandDataTransfer* next;
+    int                         fd;
+    // Sealed memfd holding the data, or -1 to write from data instead
+    int                         source_fd;
+    char*                       data;
+    size_t                      size, offset;
+    GLFWbool                    can_splice;
+    id_type                     watch, timer;
+} _GLFWWaylandDataTransfer;
+
+// A cursor theme loaded at the size matching a buffer scale
+//
+typedef struct _GLFWcursorThemeWayland
+{
+    int                         scale;
+    // NULL if the theme could not be loaded at this scale
+    struct wl_cursor_theme*     theme;
+} _GLFWcursorThemeWayland;
+
+// A cursor looked up by name in the theme for a buffer scale
+//
+typedef struct _GLFWthemeCursorWayland
+{
+    char*                       name;
+    int                         scale;
+    // The scale of the theme the cursor was found in, which is 1 if the
+    // theme could not be loaded at the requested scale
+    int                         bufferScale;
+    struct wl_cursor*           cursor;
+} _GLFWthemeCursorWayland;
+
 // Wayland-specific global data
 //
 typedef struct _GLFWlibraryWayland
@@ -204,6 +265,9 @@ typedef struct _GLFWlibraryWayland
     struct wl_keyboard*         keyboard;
     struct xdg_wm_base*         wmBase;
     struct wp_viewporter*       viewporter;
+    struct wp_presentation*     presentation;
+    // The clock of the wp_presentation timestamps
+    clockid_t                   presentationClock;
     struct zwp_relative_pointer_manager_v1* relativePointerManager;
     struct zwp_pointer_constraints_v1*      pointerConstraints;
     struct zwp_idle_inhibit_manager_v1*     idleInhibitManager;
@@ -211,10 +275,35 @@ typedef struct _GLFWlibraryWayland
     struct wl_data_device*                  dataDevice;
     struct wl_data_source*                  dataSourceForClipboard;
 
+    // The memfd backed pool that cursor and decoration buffers are
+    // allocated from, and its blocks in address order
+    struct {
+        int                     fd;
+        struct wl_shm_pool*     pool;
+        unsigned char*          data;
+        size_t                  size;
+        _GLFWshmbufferWayland*  buffers;
+        size_t                  count, capacity;
+    } shmPool;
+
     int                         compositorVersion;
     int                         seatVersion;
 
-    struct wl_cursor_theme*     cursorTheme;
+    // Cursor themes loaded for each buffer scale the pointer has been over,
+    // and the cursors looked up in them
+    struct {
+        _GLFWcursorThemeWayland* themes;
+        int                     themeCount;
+        _GLFWthemeCursorWayland* cursors;
+        int                     cursorCount, cursorCapacity;
+    } cursorCache;
+    // What the cursor surface is showing, so that setting the same cursor
+    // again does not send anything to the compositor
+    struct {
+        GLFWbool                valid;
+        struct wl_buffer*       buffer;
+        int                     xhot, yhot, scale;
+    } activeCursor;
     struct wl_surface*          cursorSurface;
     uint32_t                    pointerSerial;
 
@@ -251,6 +340,10 @@ typedef struct _GLFWlibraryWayland
 
     EventLoopData eventLoopData;
     char* clipboardString;
+    // Sealed memfd snapshot of clipboardString shared by its transfers, created
+    // on the first paste, or -1
+    int clipboardFd;
+    _GLFWWaylandDataTransfer* dataTransfers;
     char* clipboardSourceString;
     struct wl_data_offer* clipboardSourceOffer;
     size_t dataOffersCounter;
@@ -275,6 +368,9 @@ typedef struct _GLFWmonitorWayland
 //
 typedef struct _GLFWcursorWayland
 {
+    // The theme cursor name of standard cursors, whose images are looked up
+    // at the scale of the window they are set on
+    const char*                 name;
     struct wl_cursor*           cursor;
     struct wl_buffer*           buffer;
     int                         width, height;
@@ -285,4 +381,13 @@ typedef struct _GLFWcursorWayland
 
 void _glfwAddOutputWayland(uint32_t name, uint32_t version);
 void _glfwSetupWaylandDataDevice();
+void _glfwFreeDataTransfersWayland(void);
+void _glfwDestroyDataOffersWayland(void);
+void _glfwTerminateShmPoolWayland(void);
+struct wl_cursor_theme* _glfwGetCursorThemeWayland(int scale);
+struct wl_cursor* _glfwGetThemeCursorWayland(const char* name, int scale, int* bufferScale);
+void _glfwSetCursorBufferWayland(struct wl_buffer* buffer,
+                                 int width, int height,
+                                 int xhot, int yhot, int scale);
+void _glfwTerminateCursorThemesWayland(void);
 void animateCursorImage(id_type timer_id, void *data);
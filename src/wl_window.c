@@ -28,6 +28,7 @@
 
 #include "internal.h"
 #include "backend_utils.h"
+#include "pixel_convert.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -66,6 +67,8 @@ static void handleConfigure(void* data,
     float aspectRatio;
     float targetRatio;
 
+    window->wl.configurePending = GLFW_TRUE;
+
     if (!window->monitor)
     {
         if (_glfw.wl.viewporter && window->decorated)
@@ -115,6 +118,8 @@ static const struct wl_shell_surface_listener shellSurfaceListener = {
     handlePopupDone
 };
 
+#if !(defined(__linux__) && defined(MFD_CLOEXEC))
+
 static int
 createTmpfileCloexec(char* tmpname)
 {
@@ -183,57 +188,330 @@ createAnonymousFile(off_t size)
     return fd;
 }
 
-static struct wl_buffer* createShmBuffer(const GLFWimage* image)
+#endif
+
+// Grows the shared memory pool to hold at least the specified number of bytes
+//
+static GLFWbool growShmPool(size_t size)
 {
-    struct wl_shm_pool* pool;
-    struct wl_buffer* buffer;
-    int stride = image->width * 4;
-    int length = image->width * image->height * 4;
+    size_t capacity = _glfw.wl.shmPool.size ? _glfw.wl.shmPool.size : 65536;
     void* data;
-    int fd, i;
 
-    fd = createAnonymousFile(length);
-    if (fd < 0)
+    while (capacity < size)
+        capacity *= 2;
+
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    if (!_glfw.wl.shmPool.pool)
+    {
+        _glfw.wl.shmPool.fd = memfd_create("glfw-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (_glfw.wl.shmPool.fd < 0)
+        {
+            _glfwInputError(GLFW_PLATFORM_ERROR,
+                            "Wayland: Creating the shared memory pool failed: %m");
+            return GLFW_FALSE;
+        }
+    }
+
+    if (ftruncate(_glfw.wl.shmPool.fd, capacity) != 0)
     {
         _glfwInputError(GLFW_PLATFORM_ERROR,
-                        "Wayland: Creating a buffer file for %d B failed: %m",
-                        length);
+                        "Wayland: Growing the shared memory pool to %zu B failed: %m",
+                        capacity);
+        if (!_glfw.wl.shmPool.pool)
+            close(_glfw.wl.shmPool.fd);
         return GLFW_FALSE;
     }
 
-    data = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (_glfw.wl.shmPool.data)
+    {
+        data = mremap(_glfw.wl.shmPool.data, _glfw.wl.shmPool.size,
+                      capacity, MREMAP_MAYMOVE);
+    }
+    else
+    {
+        data = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    _glfw.wl.shmPool.fd, 0);
+    }
+#else
+    if (!_glfw.wl.shmPool.pool)
+    {
+        _glfw.wl.shmPool.fd = createAnonymousFile(capacity);
+        if (_glfw.wl.shmPool.fd < 0)
+        {
+            _glfwInputError(GLFW_PLATFORM_ERROR,
+                            "Wayland: Creating the shared memory pool failed: %m");
+            return GLFW_FALSE;
+        }
+    }
+    else
+    {
+        const int ret = posix_fallocate(_glfw.wl.shmPool.fd, 0, capacity);
+        if (ret != 0)
+        {
+            errno = ret;
+            _glfwInputError(GLFW_PLATFORM_ERROR,
+                            "Wayland: Growing the shared memory pool to %zu B failed: %m",
+                            capacity);
+            return GLFW_FALSE;
+        }
+    }
+
+    // Without mremap the pool is mapped again, which is fine as its buffers
+    // are located by offset
+    data = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+                _glfw.wl.shmPool.fd, 0);
+    if (data != MAP_FAILED && _glfw.wl.shmPool.data)
+        munmap(_glfw.wl.shmPool.data, _glfw.wl.shmPool.size);
+#endif
+
     if (data == MAP_FAILED)
     {
-        _glfwInputError(GLFW_PLATFORM_ERROR,
-                        "Wayland: mmap failed: %m");
-        close(fd);
+        _glfwInputError(GLFW_PLATFORM_ERROR, "Wayland: mmap failed: %m");
+        if (!_glfw.wl.shmPool.pool)
+            close(_glfw.wl.shmPool.fd);
         return GLFW_FALSE;
     }
 
-    pool = wl_shm_create_pool(_glfw.wl.shm, fd, length);
+    _glfw.wl.shmPool.data = data;
+    _glfw.wl.shmPool.size = capacity;
 
-    close(fd);
-    unsigned char* source = (unsigned char*) image->pixels;
-    unsigned char* target = data;
-    for (i = 0;  i < image->width * image->height;  i++, source += 4)
+    if (_glfw.wl.shmPool.pool)
+        wl_shm_pool_resize(_glfw.wl.shmPool.pool, capacity);
+    else
     {
-        unsigned int alpha = source[3];
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+        // The compositor maps the pool too, and must not be made to fault
+        // by it shrinking under it
+        fcntl(_glfw.wl.shmPool.fd, F_ADD_SEALS, F_SEAL_SHRINK);
+#endif
+        _glfw.wl.shmPool.pool =
+            wl_shm_create_pool(_glfw.wl.shm, _glfw.wl.shmPool.fd, capacity);
+    }
+
+    return GLFW_TRUE;
+}
+
+// Returns the pool entry of a buffer created by createShmBuffer
+//
+// Entries move as blocks are split and merged, but a buffer keeps its offset,
+// which is stored as its user data and looked up in the address ordered pool
+//
+static _GLFWshmbufferWayland* findShmBuffer(struct wl_buffer* buffer)
+{
+    const size_t offset = (size_t) (uintptr_t) wl_buffer_get_user_data(buffer);
+    size_t lower = 0, upper = _glfw.wl.shmPool.count;
 
-        *target++ = (unsigned char) ((source[2] * alpha) / 255);
-        *target++ = (unsigned char) ((source[1] * alpha) / 255);
-        *target++ = (unsigned char) ((source[0] * alpha) / 255);
-        *target++ = (unsigned char) alpha;
+    while (lower < upper)
+    {
+        const size_t middle = lower + (upper - lower) / 2;
+        if (_glfw.wl.shmPool.buffers[middle].offset < offset)
+            lower = middle + 1;
+        else
+            upper = middle;
     }
 
-    buffer =
-        wl_shm_pool_create_buffer(pool, 0,
-                                  image->width,
-                                  image->height,
-                                  stride, WL_SHM_FORMAT_ARGB8888);
-    munmap(data, length);
-    wl_shm_pool_destroy(pool);
+    // Empty blocks share their offset with the block after them
+    for (;  lower < _glfw.wl.shmPool.count;  lower++)
+    {
+        _GLFWshmbufferWayland* entry = _glfw.wl.shmPool.buffers + lower;
+        if (entry->offset != offset)
+            break;
+        if (entry->buffer == buffer)
+            return entry;
+    }
 
-    return buffer;
+    return NULL;
+}
+
+static void shmBufferHandleRelease(void* data, struct wl_buffer* buffer)
+{
+    _GLFWshmbufferWayland* entry = findShmBuffer(buffer);
+    if (entry)
+        entry->busy = GLFW_FALSE;
+}
+
+static const struct wl_buffer_listener shmBufferListener = {
+    shmBufferHandleRelease
+};
+
+// Inserts an unused entry for a block of the pool before the specified index
+//
+static _GLFWshmbufferWayland* insertShmBuffer(size_t index,
+                                              size_t offset, size_t size)
+{
+    _GLFWshmbufferWayland* entry;
+
+    if (_glfw.wl.shmPool.count == _glfw.wl.shmPool.capacity)
+    {
+        const size_t capacity = _glfw.wl.shmPool.capacity ? _glfw.wl.shmPool.capacity * 2 : 16;
+        void* buffers = realloc(_glfw.wl.shmPool.buffers,
+                                capacity * sizeof(_GLFWshmbufferWayland));
+        if (!buffers)
+        {
+            _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+            return NULL;
+        }
+
+        _glfw.wl.shmPool.buffers = buffers;
+        _glfw.wl.shmPool.capacity = capacity;
+    }
+
+    entry = _glfw.wl.shmPool.buffers + index;
+    memmove(entry + 1, entry,
+            (_glfw.wl.shmPool.count - index) * sizeof(_GLFWshmbufferWayland));
+    _glfw.wl.shmPool.count++;
+
+    memset(entry, 0, sizeof(_GLFWshmbufferWayland));
+    entry->offset = offset;
+    entry->size = size;
+    return entry;
+}
+
+static GLFWbool isShmBufferFree(const _GLFWshmbufferWayland* entry)
+{
+    return !entry->owned && !entry->busy;
+}
+
+// Forgets that the cursor surface is showing the buffer, which is about to be
+// given other contents or destroyed
+//
+static void forgetCursorBuffer(struct wl_buffer* buffer)
+{
+    if (_glfw.wl.activeCursor.buffer == buffer)
+        _glfw.wl.activeCursor.valid = GLFW_FALSE;
+}
+
+// Finds or makes room in the pool for a buffer of the specified size
+//
+// Blocks are kept in address order.  A free block keeps its wl_buffer so that
+// it can be handed out again as is to a request of the same dimensions, and is
+// otherwise merged with the free blocks after it until it is large enough
+//
+static _GLFWshmbufferWayland* allocateShmBuffer(int width, int height)
+{
+    const size_t size = (size_t) width * height * 4;
+    _GLFWshmbufferWayland* entry;
+    size_t i, end;
+
+    for (i = 0;  i < _glfw.wl.shmPool.count;  i++)
+    {
+        entry = _glfw.wl.shmPool.buffers + i;
+        if (isShmBufferFree(entry) && entry->buffer &&
+            entry->width == width && entry->height == height)
+        {
+            forgetCursorBuffer(entry->buffer);
+            return entry;
+        }
+    }
+
+    for (i = 0;  i < _glfw.wl.shmPool.count;  i++)
+    {
+        entry = _glfw.wl.shmPool.buffers + i;
+        if (!isShmBufferFree(entry))
+            continue;
+
+        while (entry->size < size &&
+               i + 1 < _glfw.wl.shmPool.count &&
+               isShmBufferFree(entry + 1))
+        {
+            if (entry[1].buffer)
+            {
+                forgetCursorBuffer(entry[1].buffer);
+                wl_buffer_destroy(entry[1].buffer);
+            }
+
+            entry->size += entry[1].size;
+            memmove(entry + 1, entry + 2,
+                    (_glfw.wl.shmPool.count - i - 2) * sizeof(_GLFWshmbufferWayland));
+            _glfw.wl.shmPool.count--;
+        }
+
+        if (entry->size < size)
+            continue;
+
+        if (entry->buffer)
+        {
+            forgetCursorBuffer(entry->buffer);
+            wl_buffer_destroy(entry->buffer);
+            entry->buffer = NULL;
+        }
+
+        if (entry->size > size)
+        {
+            if (!insertShmBuffer(i + 1, entry->offset + size, entry->size - size))
+                return NULL;
+
+            entry = _glfw.wl.shmPool.buffers + i;
+            entry->size = size;
+        }
+
+        return entry;
+    }
+
+    end = 0;
+    if (_glfw.wl.shmPool.count)
+    {
+        entry = _glfw.wl.shmPool.buffers + _glfw.wl.shmPool.count - 1;
+        end = entry->offset + entry->size;
+    }
+
+    if (end + size > _glfw.wl.shmPool.size && !growShmPool(end + size))
+        return NULL;
+
+    return insertShmBuffer(_glfw.wl.shmPool.count, end, size);
+}
+
+// Creates a buffer holding the premultiplied image, sub-allocated from the
+// shared memory pool
+//
+static struct wl_buffer* createShmBuffer(const GLFWimage* image)
+{
+    _GLFWshmbufferWayland* entry;
+
+    entry = allocateShmBuffer(image->width, image->height);
+    if (!entry)
+        return NULL;
+
+    premultiplyToBGRA(_glfw.wl.shmPool.data + entry->offset,
+                      image->pixels, (size_t) image->width * image->height);
+
+    if (!entry->buffer)
+    {
+        entry->buffer =
+            wl_shm_pool_create_buffer(_glfw.wl.shmPool.pool, entry->offset,
+                                      image->width,
+                                      image->height,
+                                      image->width * 4, WL_SHM_FORMAT_ARGB8888);
+        wl_buffer_add_listener(entry->buffer, &shmBufferListener,
+                               (void*) (uintptr_t) entry->offset);
+        entry->width = image->width;
+        entry->height = image->height;
+    }
+
+    entry->owned = GLFW_TRUE;
+    return entry->buffer;
+}
+
+// Returns a buffer created by createShmBuffer to the pool, which reuses it
+// once the compositor has released it
+//
+static void releaseShmBuffer(struct wl_buffer* buffer)
+{
+    _GLFWshmbufferWayland* entry = findShmBuffer(buffer);
+    if (entry)
+        entry->owned = GLFW_FALSE;
+}
+
+// Attaches the buffer to the surface, keeping it from being reused until the
+// compositor releases it
+//
+static void attachBuffer(struct wl_surface* surface, struct wl_buffer* buffer)
+{
+    _GLFWshmbufferWayland* entry = findShmBuffer(buffer);
+    if (entry)
+        entry->busy = GLFW_TRUE;
+
+    wl_surface_attach(surface, buffer, 0, 0);
 }
 
 static void createDecoration(_GLFWdecorationWayland* decoration,
@@ -252,7 +530,7 @@ static void createDecoration(_GLFWdecorationWayland* decoration,
     decoration->viewport = wp_viewporter_get_viewport(_glfw.wl.viewporter,
                                                       decoration->surface);
     wp_viewport_set_destination(decoration->viewport, width, height);
-    wl_surface_attach(decoration->surface, buffer, 0, 0);
+    attachBuffer(decoration->surface, buffer);
 
     if (opaque)
     {
@@ -396,6 +674,10 @@ static void checkScaleChange(_GLFWwindow* window)
         window->wl.scale = scale;
         wl_surface_set_buffer_scale(window->wl.surface, scale);
         resizeWindow(window);
+
+        // Switch the cursor to the images for the new scale
+        if (window == _glfw.wl.pointerFocus)
+            _glfwPlatformSetCursor(window, window->wl.currentCursor);
     }
 }
 
@@ -634,6 +916,9 @@ static void xdgSurfaceHandleConfigure(void* data,
                                       struct xdg_surface* surface,
                                       uint32_t serial)
 {
+    _GLFWwindow* window = data;
+
+    window->wl.configurePending = GLFW_TRUE;
     xdg_surface_ack_configure(surface, serial);
 }
 
@@ -703,17 +988,30 @@ static GLFWbool createXdgSurface(_GLFWwindow* window)
 }
 
 static void
-setCursorImage(_GLFWcursorWayland* cursorWayland)
+setCursorImage(_GLFWwindow* window, _GLFWcursorWayland* cursorWayland)
 {
     struct wl_cursor_image* image;
     struct wl_buffer* buffer;
-    struct wl_surface* surface = _glfw.wl.cursorSurface;
+    int scale = 1;
 
-    if (!cursorWayland->cursor) {
+    if (!cursorWayland->name) {
         buffer = cursorWayland->buffer;
         toggleTimer(&_glfw.wl.eventLoopData, _glfw.wl.cursorAnimationTimer, 0);
     } else
     {
+        cursorWayland->cursor = _glfwGetThemeCursorWayland(cursorWayland->name,
+                                                           window->wl.scale,
+                                                           &scale);
+        if (!cursorWayland->cursor)
+        {
+            _glfwInputError(GLFW_PLATFORM_ERROR,
+                            "Wayland: Standard cursor \"%s\" not found",
+                            cursorWayland->name);
+            return;
+        }
+
+        // The theme for another scale may have a different number of frames
+        cursorWayland->currentImage %= cursorWayland->cursor->image_count;
         image = cursorWayland->cursor->images[cursorWayland->currentImage];
         buffer = wl_cursor_image_get_buffer(image);
         if (image->delay) {
@@ -732,14 +1030,10 @@ setCursorImage(_GLFWcursorWayland* cursorWayland)
         cursorWayland->yhot = image->hotspot_y;
     }
 
-    wl_pointer_set_cursor(_glfw.wl.pointer, _glfw.wl.pointerSerial,
-                          surface,
-                          cursorWayland->xhot,
-                          cursorWayland->yhot);
-    wl_surface_attach(surface, buffer, 0, 0);
-    wl_surface_damage(surface, 0, 0,
-                      cursorWayland->width, cursorWayland->height);
-    wl_surface_commit(surface);
+    _glfwSetCursorBufferWayland(buffer,
+                                cursorWayland->width, cursorWayland->height,
+                                cursorWayland->xhot, cursorWayland->yhot,
+                                scale);
 }
 
 static void
@@ -751,7 +1045,7 @@ incrementCursorImage(_GLFWwindow* window)
         {
             cursor->wl.currentImage += 1;
             cursor->wl.currentImage %= cursor->wl.cursor->image_count;
-            setCursorImage(&cursor->wl);
+            setCursorImage(window, &cursor->wl);
             return;
         }
     }
@@ -822,6 +1116,254 @@ static char *translateCursorShape(int shape)
     return NULL;
 }
 
+// Notifies shared code that the frame requested by glfwRequestWindowFrame is
+// due
+//
+static void frameHandleDone(void* data,
+                            struct wl_callback* callback,
+                            uint32_t time)
+{
+    _GLFWwindow* window = data;
+
+    wl_callback_destroy(callback);
+    window->wl.frameCallback = NULL;
+    _glfwInputFrameReady(window);
+}
+
+static const struct wl_callback_listener frameListener = {
+    frameHandleDone
+};
+
+static void feedbackHandleSyncOutput(void* data,
+                                     struct wp_presentation_feedback* feedback,
+                                     struct wl_output* output)
+{
+}
+
+// Notifies shared code that a frame swapped by glfwSwapBuffers has been shown.
+// The feedback refers to its window by ID, as the window may be destroyed first
+//
+static void feedbackHandlePresented(void* data,
+                                    struct wp_presentation_feedback* feedback,
+                                    uint32_t tv_sec_hi,
+                                    uint32_t tv_sec_lo,
+                                    uint32_t tv_nsec,
+                                    uint32_t refresh,
+                                    uint32_t seq_hi,
+                                    uint32_t seq_lo,
+                                    uint32_t flags)
+{
+    _GLFWwindow* window = _glfwWindowForId((uintptr_t) data);
+    const double seconds =
+        (double) (((uint64_t) tv_sec_hi << 32) | tv_sec_lo) + tv_nsec / 1e9;
+
+    wp_presentation_feedback_destroy(feedback);
+    if (window)
+    {
+        _glfwInputFramePresented(window,
+                                 _glfwTimeFromClockPOSIX(_glfw.wl.presentationClock, seconds),
+                                 refresh / 1e9,
+                                 flags);
+    }
+}
+
+static void feedbackHandleDiscarded(void* data,
+                                    struct wp_presentation_feedback* feedback)
+{
+    wp_presentation_feedback_destroy(feedback);
+}
+
+static const struct wp_presentation_feedback_listener feedbackListener = {
+    feedbackHandleSyncOutput,
+    feedbackHandlePresented,
+    feedbackHandleDiscarded
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+//////                       GLFW internal API                      //////
+//////////////////////////////////////////////////////////////////////////
+
+// Destroys the shared memory pool and the buffers left in it
+//
+void _glfwTerminateShmPoolWayland(void)
+{
+    size_t i;
+
+    for (i = 0;  i < _glfw.wl.shmPool.count;  i++)
+    {
+        if (_glfw.wl.shmPool.buffers[i].buffer)
+            wl_buffer_destroy(_glfw.wl.shmPool.buffers[i].buffer);
+    }
+
+    free(_glfw.wl.shmPool.buffers);
+
+    if (_glfw.wl.shmPool.pool)
+    {
+        wl_shm_pool_destroy(_glfw.wl.shmPool.pool);
+        close(_glfw.wl.shmPool.fd);
+    }
+
+    if (_glfw.wl.shmPool.data)
+        munmap(_glfw.wl.shmPool.data, _glfw.wl.shmPool.size);
+
+    memset(&_glfw.wl.shmPool, 0, sizeof(_glfw.wl.shmPool));
+}
+
+// Returns the cursor theme for the buffer scale, loading it the first time
+// that scale is asked for
+//
+struct wl_cursor_theme* _glfwGetCursorThemeWayland(int scale)
+{
+    _GLFWcursorThemeWayland* themes;
+    struct wl_cursor_theme* theme;
+    int i;
+
+    for (i = 0;  i < _glfw.wl.cursorCache.themeCount;  i++)
+    {
+        if (_glfw.wl.cursorCache.themes[i].scale == scale)
+            return _glfw.wl.cursorCache.themes[i].theme;
+    }
+
+    themes = realloc(_glfw.wl.cursorCache.themes,
+                     (_glfw.wl.cursorCache.themeCount + 1) * sizeof(_GLFWcursorThemeWayland));
+    if (!themes)
+        return NULL;
+
+    // Themes that fail to load are remembered too, so that they are not
+    // retried on every pointer motion
+    theme = wl_cursor_theme_load(NULL, _GLFW_CURSOR_SIZE * scale, _glfw.wl.shm);
+    themes[_glfw.wl.cursorCache.themeCount].scale = scale;
+    themes[_glfw.wl.cursorCache.themeCount].theme = theme;
+    _glfw.wl.cursorCache.themes = themes;
+    _glfw.wl.cursorCache.themeCount++;
+    return theme;
+}
+
+// Returns the named cursor from the theme for the buffer scale, falling back
+// to the unscaled theme, and stores the scale of its images in bufferScale.
+// Only the first lookup of a name at a scale searches the theme
+//
+struct wl_cursor* _glfwGetThemeCursorWayland(const char* name, int scale, int* bufferScale)
+{
+    _GLFWthemeCursorWayland* entry;
+    struct wl_cursor_theme* theme;
+    struct wl_cursor* cursor = NULL;
+    int i, found = 1;
+
+    for (i = 0;  i < _glfw.wl.cursorCache.cursorCount;  i++)
+    {
+        entry = _glfw.wl.cursorCache.cursors + i;
+        if (entry->scale == scale && strcmp(entry->name, name) == 0)
+        {
+            *bufferScale = entry->bufferScale;
+            return entry->cursor;
+        }
+    }
+
+    theme = _glfwGetCursorThemeWayland(scale);
+    if (theme)
+    {
+        found = scale;
+        cursor = wl_cursor_theme_get_cursor(theme, name);
+    }
+    else if (scale != 1)
+        cursor = _glfwGetThemeCursorWayland(name, 1, &found);
+
+    if (_glfw.wl.cursorCache.cursorCount == _glfw.wl.cursorCache.cursorCapacity)
+    {
+        int capacity = _glfw.wl.cursorCache.cursorCapacity ? 2 * _glfw.wl.cursorCache.cursorCapacity : 16;
+        entry = realloc(_glfw.wl.cursorCache.cursors,
+                        capacity * sizeof(_GLFWthemeCursorWayland));
+        if (!entry)
+        {
+            *bufferScale = found;
+            return cursor;
+        }
+
+        _glfw.wl.cursorCache.cursors = entry;
+        _glfw.wl.cursorCache.cursorCapacity = capacity;
+    }
+
+    // Missing cursors are remembered as well, as the decorations ask for
+    // them on every pointer motion
+    entry = _glfw.wl.cursorCache.cursors + _glfw.wl.cursorCache.cursorCount;
+    entry->name = _glfw_strdup(name);
+    if (entry->name)
+        _glfw.wl.cursorCache.cursorCount++;
+    entry->scale = scale;
+    entry->bufferScale = found;
+    entry->cursor = cursor;
+
+    *bufferScale = found;
+    return cursor;
+}
+
+// Shows the buffer as the pointer cursor, or hides the cursor if the buffer
+// is NULL. The width, height and hotspot are in buffer pixels. Nothing is
+// sent if the cursor surface is already showing the same thing
+//
+void _glfwSetCursorBufferWayland(struct wl_buffer* buffer,
+                                 int width, int height,
+                                 int xhot, int yhot, int scale)
+{
+    struct wl_surface* surface = _glfw.wl.cursorSurface;
+
+    if (_glfw.wl.activeCursor.valid &&
+        _glfw.wl.activeCursor.buffer == buffer &&
+        _glfw.wl.activeCursor.xhot == xhot &&
+        _glfw.wl.activeCursor.yhot == yhot &&
+        _glfw.wl.activeCursor.scale == scale)
+    {
+        return;
+    }
+
+    _glfw.wl.activeCursor.valid = GLFW_TRUE;
+    _glfw.wl.activeCursor.buffer = buffer;
+    _glfw.wl.activeCursor.xhot = xhot;
+    _glfw.wl.activeCursor.yhot = yhot;
+    _glfw.wl.activeCursor.scale = scale;
+
+    if (!buffer)
+    {
+        wl_pointer_set_cursor(_glfw.wl.pointer, _glfw.wl.pointerSerial,
+                              NULL, 0, 0);
+        return;
+    }
+
+    wl_pointer_set_cursor(_glfw.wl.pointer, _glfw.wl.pointerSerial,
+                          surface,
+                          xhot / scale,
+                          yhot / scale);
+    if (_glfw.wl.compositorVersion >= 3)
+        wl_surface_set_buffer_scale(surface, scale);
+    attachBuffer(surface, buffer);
+    wl_surface_damage(surface, 0, 0, width / scale, height / scale);
+    wl_surface_commit(surface);
+}
+
+// Destroys the cursor themes and forgets the cursors looked up in them
+//
+void _glfwTerminateCursorThemesWayland(void)
+{
+    int i;
+
+    for (i = 0;  i < _glfw.wl.cursorCache.themeCount;  i++)
+    {
+        if (_glfw.wl.cursorCache.themes[i].theme)
+            wl_cursor_theme_destroy(_glfw.wl.cursorCache.themes[i].theme);
+    }
+
+    for (i = 0;  i < _glfw.wl.cursorCache.cursorCount;  i++)
+        free(_glfw.wl.cursorCache.cursors[i].name);
+
+    free(_glfw.wl.cursorCache.themes);
+    free(_glfw.wl.cursorCache.cursors);
+    memset(&_glfw.wl.cursorCache, 0, sizeof(_glfw.wl.cursorCache));
+    memset(&_glfw.wl.activeCursor, 0, sizeof(_glfw.wl.activeCursor));
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 //////                       GLFW platform API                      //////
 //////////////////////////////////////////////////////////////////////////
@@ -908,12 +1450,15 @@ void _glfwPlatformDestroyWindow(_GLFWwindow* window)
     if (window->wl.idleInhibitor)
         zwp_idle_inhibitor_v1_destroy(window->wl.idleInhibitor);
 
+    if (window->wl.frameCallback)
+        wl_callback_destroy(window->wl.frameCallback);
+
     if (window->context.destroy)
         window->context.destroy(window);
 
     destroyDecorations(window);
     if (window->wl.decorations.buffer)
-        wl_buffer_destroy(window->wl.decorations.buffer);
+        releaseShmBuffer(window->wl.decorations.buffer);
 
     if (window->wl.native)
         wl_egl_window_destroy(window->wl.native);
@@ -1239,6 +1784,38 @@ void _glfwPlatformSetWindowOpacity(_GLFWwindow* window, float opacity)
 {
 }
 
+void _glfwPlatformRequestWindowFrame(_GLFWwindow* window)
+{
+    if (window->wl.frameCallback)
+        return;
+
+    window->wl.frameCallback = wl_surface_frame(window->wl.surface);
+    wl_callback_add_listener(window->wl.frameCallback, &frameListener, window);
+    // The request only takes effect on commit, and the application may be
+    // waiting for the callback before it draws anything.  After a configure
+    // the pending state belongs to the next buffer swap, which carries the
+    // request instead
+    if (!window->wl.configurePending)
+        wl_surface_commit(window->wl.surface);
+}
+
+void _glfwPlatformPrepareFramePresentation(_GLFWwindow* window)
+{
+    struct wp_presentation_feedback* feedback;
+
+    // The swap commits a buffer drawn for the last configure
+    window->wl.configurePending = GLFW_FALSE;
+
+    if (!window->callbacks.framePresented || !_glfw.wl.presentation)
+        return;
+
+    // The feedback applies to the next commit of the surface, which is the
+    // one made by the buffer swap
+    feedback = wp_presentation_feedback(_glfw.wl.presentation, window->wl.surface);
+    wp_presentation_feedback_add_listener(feedback, &feedbackListener,
+                                          (void*) (uintptr_t) window->id);
+}
+
 void _glfwPlatformPollEvents(void)
 {
     wl_display_dispatch_pending(_glfw.wl.display);
@@ -1259,8 +1836,7 @@ void _glfwPlatformWaitEventsTimeout(double timeout)
 
 void _glfwPlatformPostEmptyEvent(void)
 {
-    wl_display_sync(_glfw.wl.display);
-    while (write(_glfw.wl.eventLoopData.wakeupFds[1], "w", 1) < 0 && errno == EINTR);
+    wakeupEventLoop(&_glfw.wl.eventLoopData);
 }
 
 void _glfwPlatformGetCursorPos(_GLFWwindow* window, double* xpos, double* ypos)
@@ -1304,6 +1880,9 @@ int _glfwPlatformCreateCursor(_GLFWcursor* cursor,
                               int xhot, int yhot, int count)
 {
     cursor->wl.buffer = createShmBuffer(image);
+    if (!cursor->wl.buffer)
+        return GLFW_FALSE;
+
     cursor->wl.width = image->width;
     cursor->wl.height = image->height;
     cursor->wl.xhot = xhot;
@@ -1314,9 +1893,10 @@ int _glfwPlatformCreateCursor(_GLFWcursor* cursor,
 int _glfwPlatformCreateStandardCursor(_GLFWcursor* cursor, int shape)
 {
     struct wl_cursor* standardCursor;
+    int scale;
 
-    standardCursor = wl_cursor_theme_get_cursor(_glfw.wl.cursorTheme,
-                                                translateCursorShape(shape));
+    standardCursor = _glfwGetThemeCursorWayland(translateCursorShape(shape),
+                                                1, &scale);
     if (!standardCursor)
     {
         _glfwInputError(GLFW_PLATFORM_ERROR,
@@ -1325,6 +1905,7 @@ int _glfwPlatformCreateStandardCursor(_GLFWcursor* cursor, int shape)
         return GLFW_FALSE;
     }
 
+    cursor->wl.name = translateCursorShape(shape);
     cursor->wl.cursor = standardCursor;
     cursor->wl.currentImage = 0;
     return GLFW_TRUE;
@@ -1337,7 +1918,7 @@ void _glfwPlatformDestroyCursor(_GLFWcursor* cursor)
         return;
 
     if (cursor->wl.buffer)
-        wl_buffer_destroy(cursor->wl.buffer);
+        releaseShmBuffer(cursor->wl.buffer);
 }
 
 static void handleRelativeMotion(void* data,
@@ -1354,6 +1935,9 @@ static void handleRelativeMotion(void* data,
     if (window->cursorMode != GLFW_CURSOR_DISABLED)
         return;
 
+    // The timestamp is in microseconds, on the same clock as the
+    // millisecond timestamps of the other pointer events
+    _glfwInputEventTimestamp((uint32_t) ((((uint64_t) timeHi << 32) | timeLo) / 1000));
     _glfwInputCursorPos(window,
                         window->virtualCursorPosX + wl_fixed_to_double(dxUnaccel),
                         window->virtualCursorPosY + wl_fixed_to_double(dyUnaccel));
@@ -1428,8 +2012,7 @@ static void lockPointer(_GLFWwindow* window)
     window->wl.pointerLock.relativePointer = relativePointer;
     window->wl.pointerLock.lockedPointer = lockedPointer;
 
-    wl_pointer_set_cursor(_glfw.wl.pointer, _glfw.wl.pointerSerial,
-                          NULL, 0, 0);
+    _glfwSetCursorBufferWayland(NULL, 0, 0, 0, 0, 1);
 }
 
 static GLFWbool isPointerLocked(_GLFWwindow* window)
@@ -1439,8 +2022,6 @@ static GLFWbool isPointerLocked(_GLFWwindow* window)
 
 void _glfwPlatformSetCursor(_GLFWwindow* window, _GLFWcursor* cursor)
 {
-    struct wl_cursor* defaultCursor;
-
     if (!_glfw.wl.pointer)
         return;
 
@@ -1458,25 +2039,18 @@ void _glfwPlatformSetCursor(_GLFWwindow* window, _GLFWcursor* cursor)
     if (window->cursorMode == GLFW_CURSOR_NORMAL)
     {
         if (cursor)
-            setCursorImage(&cursor->wl);
+            setCursorImage(window, &cursor->wl);
         else
         {
-            defaultCursor = wl_cursor_theme_get_cursor(_glfw.wl.cursorTheme,
-                                                       "left_ptr");
-            if (!defaultCursor)
-            {
-                _glfwInputError(GLFW_PLATFORM_ERROR,
-                                "Wayland: Standard cursor not found");
-                return;
-            }
             _GLFWcursorWayland cursorWayland = {
-                defaultCursor,
+                "left_ptr",
+                NULL,
                 NULL,
                 0, 0,
                 0, 0,
                 0
             };
-            setCursorImage(&cursorWayland);
+            setCursorImage(window, &cursorWayland);
         }
     }
     else if (window->cursorMode == GLFW_CURSOR_DISABLED)
@@ -1486,50 +2060,175 @@ void _glfwPlatformSetCursor(_GLFWwindow* window, _GLFWcursor* cursor)
     }
     else if (window->cursorMode == GLFW_CURSOR_HIDDEN)
     {
-        wl_pointer_set_cursor(_glfw.wl.pointer, _glfw.wl.pointerSerial,
-                              NULL, 0, 0);
+        _glfwSetCursorBufferWayland(NULL, 0, 0, 0, 0, 1);
     }
 }
 
-static void _glfwSendClipboardText(void *data, struct wl_data_source *data_source, const char *mime_type, int fd)
-{
-    if (_glfw.wl.clipboardString) {
-        size_t len = strlen(_glfw.wl.clipboardString), pos = 0;
-        double start = glfwGetTime();
-        while (pos < len && glfwGetTime() - start < 2.0) {
-            ssize_t ret = write(fd, _glfw.wl.clipboardString + pos, len - pos);
-            if (ret < 0) {
-                if (errno == EAGAIN || errno == EINTR) continue;
+static void
+free_data_transfer(_GLFWWaylandDataTransfer *t) {
+    _GLFWWaylandDataTransfer **prev = &_glfw.wl.dataTransfers;
+    while (*prev != t) prev = &((*prev)->next);
+    *prev = t->next;
+    if (t->watch) removeWatch(&_glfw.wl.eventLoopData, t->watch);
+    if (t->timer) removeTimer(&_glfw.wl.eventLoopData, t->timer);
+    close(t->fd);
+    if (t->source_fd >= 0) close(t->source_fd);
+    free(t->data);
+    free(t);
+}
+
+void
+_glfwFreeDataTransfersWayland(void) {
+    while (_glfw.wl.dataTransfers) free_data_transfer(_glfw.wl.dataTransfers);
+    if (_glfw.wl.clipboardFd >= 0) close(_glfw.wl.clipboardFd);
+    _glfw.wl.clipboardFd = -1;
+}
+
+// Copies the clipboard into a sealed memfd, from which it can be spliced into
+// any number of paste targets without further copies
+static int
+create_clipboard_memfd(const char *data, size_t size) {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    int fd = memfd_create("glfw-clipboard", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) return -1;
+    if (!writeAll(fd, data, size)) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+    return fd;
+#else
+    (void)data; (void)size;
+    return -1;
+#endif
+}
+
+static ssize_t
+write_data_chunk(_GLFWWaylandDataTransfer *t) {
+    size_t remaining = t->size - t->offset;
+#ifdef __linux__
+    if (t->can_splice) {
+        loff_t offset = t->offset;
+        ssize_t ret = splice(t->source_fd, &offset, t->fd, NULL, remaining, SPLICE_F_NONBLOCK);
+        // Only pipes can be spliced into
+        if (ret >= 0 || errno != EINVAL) return ret;
+        t->can_splice = GLFW_FALSE;
+    }
+#endif
+    if (t->source_fd >= 0) {
+        char buf[65536];
+        ssize_t ret = pread(t->source_fd, buf, remaining < sizeof(buf) ? remaining : sizeof(buf), t->offset);
+        if (ret <= 0) {
+            if (ret == 0) errno = EIO;
+            return -1;
+        }
+        return write(t->fd, buf, ret);
+    }
+    return write(t->fd, t->data + t->offset, remaining);
+}
+
+static void
+write_data_transfer(int fd, int events, void *data) {
+    _GLFWWaylandDataTransfer *t = data;
+    if (events & (POLLERR | POLLHUP)) {
+        // The paste target closed its end of the pipe
+        free_data_transfer(t);
+        return;
+    }
+    // Write a bounded number of chunks per wakeup so that a fast reader does
+    // not starve the rest of the event loop
+    for (int i = 0; i < 16 && t->offset < t->size; i++) {
+        ssize_t ret = write_data_chunk(t);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno != EPIPE)
                 _glfwInputError(GLFW_PLATFORM_ERROR,
                     "Wayland: Could not copy writing to destination fd failed with error: %s", strerror(errno));
-                break;
-            }
-            if (ret > 0) {
-                start = glfwGetTime();
-                pos += ret;
-            }
+            free_data_transfer(t);
+            return;
         }
+        t->offset += ret;
     }
-    close(fd);
+    if (t->offset >= t->size) free_data_transfer(t);
+    else toggleTimer(&_glfw.wl.eventLoopData, t->timer, 1);
 }
 
-static char* read_data_offer(struct wl_data_offer *data_offer, const char *mime) {
+static void
+data_transfer_timed_out(id_type timer_id, void *data) {
+    _glfwInputError(GLFW_PLATFORM_ERROR, "Wayland: Could not copy, the paste target stopped reading");
+    free_data_transfer(data);
+}
+
+// Returns the contents of the clipboard we own in the MIME type, or NULL if
+// they are not available in it
+static const char*
+get_own_clipboard_data(const char *mime, size_t *size) {
+    const GLFWbool is_text = _glfwIsTextMime(mime) || strcmp(mime, clipboard_mime()) == 0;
+    if (_glfw.wl.clipboardString) {
+        if (!is_text) return NULL;
+        *size = strlen(_glfw.wl.clipboardString);
+        return _glfw.wl.clipboardString;
+    }
+    return _glfwGetClipboardProviderData(is_text ? "text/plain;charset=utf-8" : mime, size);
+}
+
+static void _glfwSendClipboardText(void *data, struct wl_data_source *data_source, const char *mime_type, int fd)
+{
+    size_t size;
+    const char *contents = get_own_clipboard_data(mime_type, &size);
+    if (!contents) { close(fd); return; }
+    _GLFWWaylandDataTransfer *t = calloc(1, sizeof(_GLFWWaylandDataTransfer));
+    if (!t) { close(fd); return; }
+    t->fd = fd;
+    t->source_fd = -1;
+    t->size = size;
+    t->next = _glfw.wl.dataTransfers;
+    _glfw.wl.dataTransfers = t;
+    if (_glfw.wl.clipboardString) {
+        if (_glfw.wl.clipboardFd < 0)
+            _glfw.wl.clipboardFd = create_clipboard_memfd(_glfw.wl.clipboardString, t->size);
+        // Each transfer holds its own reference, so that replacing the clipboard
+        // does not cut short the pastes in progress
+        if (_glfw.wl.clipboardFd >= 0) t->source_fd = fcntl(_glfw.wl.clipboardFd, F_DUPFD_CLOEXEC, 0);
+    } else {
+        // Provided types are usually pasted once each, so every transfer gets
+        // a memfd of its own rather than one cached per type
+        t->source_fd = create_clipboard_memfd(contents, t->size);
+    }
+    t->can_splice = t->source_fd >= 0;
+    if (t->source_fd < 0) {
+        t->data = malloc(t->size + 1);
+        if (!t->data) { free_data_transfer(t); return; }
+        memcpy(t->data, contents, t->size);
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    t->watch = addWatch(&_glfw.wl.eventLoopData, "clipboard send", fd, POLLOUT, 1, write_data_transfer, t);
+    if (!t->watch) { free_data_transfer(t); return; }
+    t->timer = addTimer(&_glfw.wl.eventLoopData, "clipboard send", 2.0, 1, data_transfer_timed_out, t);
+}
+
+// Reads the offer in the MIME type into tb or, if tb is NULL, passes it to the
+// callback in chunks as they arrive through the pipe
+static GLFWbool
+receive_data_offer(struct wl_data_offer *data_offer, const char *mime, TransferBuffer *tb,
+                   GLFWclipboarddatafun callback, void *user_data) {
     int pipefd[2];
-    if (pipe2(pipefd, O_CLOEXEC) != 0) return NULL;
+    if (pipe2(pipefd, O_CLOEXEC) != 0) {
+        _glfwInputError(GLFW_PLATFORM_ERROR, "Wayland: Failed to create pipe for clipboard data with error: %s", strerror(errno));
+        return GLFW_FALSE;
+    }
     wl_data_offer_receive(data_offer, mime, pipefd[1]);
     close(pipefd[1]);
     wl_display_flush(_glfw.wl.display);
-    size_t sz = 0, capacity = 0;
-    char *buf = NULL;
     struct pollfd fds;
     fds.fd = pipefd[0];
     fds.events = POLLIN;
     double start = glfwGetTime();
 #define bail(...) { \
     _glfwInputError(GLFW_PLATFORM_ERROR, __VA_ARGS__); \
-    free(buf); buf = NULL; \
     close(pipefd[0]); \
-    return NULL; \
+    return GLFW_FALSE; \
 }
 
     while (glfwGetTime() - start < 2) {
@@ -1541,20 +2240,20 @@ static char* read_data_offer(struct wl_data_offer *data_offer, const char *mime)
         if (!ret) {
             bail("Wayland: Failed to read clipboard data from pipe (timed out)");
         }
-        if (capacity <= sz || capacity - sz <= 64) {
-            capacity += 4096;
-            buf = realloc(buf, capacity);
-            if (!buf) {
-                bail("Wayland: Failed to allocate memory to read clipboard data");
-            }
-        }
-        ret = read(pipefd[0], buf + sz, capacity - sz - 1);
-        if (ret == -1) {
+        char buf[65536];
+        ssize_t n = tb ? readIntoTransferBuffer(tb, pipefd[0]) : read(pipefd[0], buf, sizeof(buf));
+        if (n == -1) {
             if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
             bail("Wayland: Failed to read clipboard data from pipe with error: %s", strerror(errno));
         }
-        if (ret == 0) { close(pipefd[0]); buf[sz] = 0; return buf; }
-        sz += ret;
+        if (n > 0 && !tb) callback(buf, n, user_data);
+        if (n == 0) {
+            if (tb && !finishTransferBuffer(tb)) {
+                bail("Wayland: Failed to finish reading clipboard data with error: %s", strerror(errno));
+            }
+            close(pipefd[0]);
+            return GLFW_TRUE;
+        }
         start = glfwGetTime();
     }
     bail("Wayland: Failed to read clipboard data from pipe (timed out)");
@@ -1562,6 +2261,50 @@ static char* read_data_offer(struct wl_data_offer *data_offer, const char *mime)
 
 }
 
+static char* read_data_offer(struct wl_data_offer *data_offer, const char *mime) {
+    TransferBuffer tb;
+    char *ans = NULL;
+    if (!initTransferBuffer(&tb, 0)) {
+        _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+        return NULL;
+    }
+    if (receive_data_offer(data_offer, mime, &tb, NULL, NULL)) {
+        ans = tb.data;
+        tb.data = NULL;
+    }
+    freeTransferBuffer(&tb);
+    return ans;
+}
+
+static void
+read_clipboard_request(int fd, int events, void *data) {
+    _GLFWclipboardrequest *request = data;
+    char buf[65536];
+    ssize_t ret = read(fd, buf, sizeof(buf));
+    if (ret < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) return;
+        _glfwInputError(GLFW_PLATFORM_ERROR,
+            "Wayland: Failed to read clipboard data from pipe with error: %s", strerror(errno));
+        _glfwInputClipboardRequestDone(request, GLFW_FALSE);
+        return;
+    }
+    if (ret == 0) {
+        _glfwInputClipboardRequestDone(request, GLFW_TRUE);
+        return;
+    }
+    if (!_glfwInputClipboardRequestData(request, buf, ret)) {
+        _glfwInputClipboardRequestDone(request, GLFW_FALSE);
+        return;
+    }
+    toggleTimer(&_glfw.wl.eventLoopData, request->timer, 1);
+}
+
+static void
+clipboard_request_timed_out(id_type timer_id, void *data) {
+    _glfwInputError(GLFW_PLATFORM_ERROR, "Wayland: Failed to read clipboard data from pipe (timed out)");
+    _glfwInputClipboardRequestDone(data, GLFW_FALSE);
+}
+
 static const char* _glfwReceiveClipboardText(struct wl_data_offer *data_offer, const char *mime)
 {
     if (_glfw.wl.clipboardSourceOffer == data_offer && _glfw.wl.clipboardSourceString)
@@ -1572,8 +2315,10 @@ static const char* _glfwReceiveClipboardText(struct wl_data_offer *data_offer, c
 }
 
 static void data_source_canceled(void *data, struct wl_data_source *wl_data_source) {
-    if (_glfw.wl.dataSourceForClipboard == wl_data_source)
+    if (_glfw.wl.dataSourceForClipboard == wl_data_source) {
         _glfw.wl.dataSourceForClipboard = NULL;
+        _glfwFreeClipboardProvider(&_glfw.clipboardProvider);
+    }
     wl_data_source_destroy(wl_data_source);
 }
 
@@ -1586,11 +2331,31 @@ const static struct wl_data_source_listener data_source_listener = {
     .target = data_source_target,
 };
 
+static void
+destroy_data_offer(_GLFWWaylandDataOffer *offer) {
+    if (offer->id) wl_data_offer_destroy(offer->id);
+    for (size_t i = 0; i < offer->mimes_count; i++) free(offer->mimes[i]);
+    free(offer->mimes);
+    memset(offer, 0, sizeof(*offer));
+}
+
+void
+_glfwDestroyDataOffersWayland(void) {
+    for (size_t i = 0; i < arraysz(_glfw.wl.dataOffers); i++) destroy_data_offer(_glfw.wl.dataOffers + i);
+}
+
+static GLFWbool
+data_offer_has_mime(const _GLFWWaylandDataOffer *offer, const char *mime) {
+    for (size_t i = 0; i < offer->mimes_count; i++) {
+        if (strcmp(offer->mimes[i], mime) == 0) return GLFW_TRUE;
+    }
+    return GLFW_FALSE;
+}
+
 static void prune_unclaimed_data_offers() {
     for (size_t i = 0; i < arraysz(_glfw.wl.dataOffers); i++) {
         if (_glfw.wl.dataOffers[i].id && !_glfw.wl.dataOffers[i].offer_type) {
-            wl_data_offer_destroy(_glfw.wl.dataOffers[i].id);
-            memset(_glfw.wl.dataOffers + i, 0, sizeof(_glfw.wl.dataOffers[0]));
+            destroy_data_offer(_glfw.wl.dataOffers + i);
         }
     }
 }
@@ -1618,6 +2383,14 @@ static void handle_offer_mimetype(void *data, struct wl_data_offer* id, const ch
                 _glfw.wl.dataOffers[i].is_self_offer = 1;
             else if (strcmp(mime, URI_LIST_MIME) == 0)
                 _glfw.wl.dataOffers[i].has_uri_list = 1;
+            // Requests for other types are checked against these, as
+            // receiving a type that was not offered just yields no data
+            char **mimes = realloc(_glfw.wl.dataOffers[i].mimes, (_glfw.wl.dataOffers[i].mimes_count + 1) * sizeof(char*));
+            if (mimes) {
+                _glfw.wl.dataOffers[i].mimes = mimes;
+                mimes[_glfw.wl.dataOffers[i].mimes_count] = _glfw_strdup(mime);
+                if (mimes[_glfw.wl.dataOffers[i].mimes_count]) _glfw.wl.dataOffers[i].mimes_count++;
+            }
             break;
         }
     }
@@ -1661,8 +2434,7 @@ static void handle_data_offer(void *data, struct wl_data_device *wl_data_device,
             goto end;
         }
     }
-    if (_glfw.wl.dataOffers[pos].id) wl_data_offer_destroy(_glfw.wl.dataOffers[pos].id);
-    memset(_glfw.wl.dataOffers + pos, 0, sizeof(_glfw.wl.dataOffers[0]));
+    destroy_data_offer(_glfw.wl.dataOffers + pos);
     _glfw.wl.dataOffers[pos].id = id;
     _glfw.wl.dataOffers[pos].idx = ++_glfw.wl.dataOffersCounter;
 end:
@@ -1686,8 +2458,7 @@ static void drag_enter(void *data, struct wl_data_device *wl_data_device, uint32
 static void drag_leave(void *data, struct wl_data_device *wl_data_device) {
     for (size_t i = 0; i < arraysz(_glfw.wl.dataOffers); i++) {
         if (_glfw.wl.dataOffers[i].offer_type == 2) {
-            wl_data_offer_destroy(_glfw.wl.dataOffers[i].id);
-            memset(_glfw.wl.dataOffers + i, 0, sizeof(_glfw.wl.dataOffers[0]));
+            destroy_data_offer(_glfw.wl.dataOffers + i);
         }
     }
 }
@@ -1719,8 +2490,7 @@ static void drop(void *data, struct wl_data_device *wl_data_device) {
                 free(paths);
                 free(uri_list);
             }
-            wl_data_offer_destroy(_glfw.wl.dataOffers[i].id);
-            memset(_glfw.wl.dataOffers + i, 0, sizeof(_glfw.wl.dataOffers[0]));
+            destroy_data_offer(_glfw.wl.dataOffers + i);
             break;
         }
     }
@@ -1782,11 +2552,12 @@ static inline GLFWbool _glfwEnsureDataDevice() {
     return GLFW_TRUE;
 }
 
-void _glfwPlatformSetClipboardString(const char* string)
-{
-    if (!_glfwEnsureDataDevice()) return;
-    free(_glfw.wl.clipboardString);
-    _glfw.wl.clipboardString = _glfw_strdup(string);
+// Replaces the clipboard data source with a new one offering our private type,
+// to which the caller adds the offered types before calling set_clipboard_data_source
+static GLFWbool
+create_clipboard_data_source(void) {
+    if (_glfw.wl.clipboardFd >= 0) close(_glfw.wl.clipboardFd);
+    _glfw.wl.clipboardFd = -1;
     if (_glfw.wl.dataSourceForClipboard)
         wl_data_source_destroy(_glfw.wl.dataSourceForClipboard);
     _glfw.wl.dataSourceForClipboard = wl_data_device_manager_create_data_source(_glfw.wl.dataDeviceManager);
@@ -1794,30 +2565,125 @@ void _glfwPlatformSetClipboardString(const char* string)
     {
         _glfwInputError(GLFW_PLATFORM_ERROR,
                         "Wayland: Cannot copy failed to create data source");
-        return;
+        return GLFW_FALSE;
     }
     wl_data_source_add_listener(_glfw.wl.dataSourceForClipboard, &data_source_listener, NULL);
     wl_data_source_offer(_glfw.wl.dataSourceForClipboard, clipboard_mime());
-    wl_data_source_offer(_glfw.wl.dataSourceForClipboard, "text/plain");
-    wl_data_source_offer(_glfw.wl.dataSourceForClipboard, "text/plain;charset=utf-8");
-    wl_data_source_offer(_glfw.wl.dataSourceForClipboard, "TEXT");
-    wl_data_source_offer(_glfw.wl.dataSourceForClipboard, "STRING");
-    wl_data_source_offer(_glfw.wl.dataSourceForClipboard, "UTF8_STRING");
+    return GLFW_TRUE;
+}
+
+static void
+offer_text_mimes(struct wl_data_source *source) {
+    wl_data_source_offer(source, "text/plain");
+    wl_data_source_offer(source, "text/plain;charset=utf-8");
+    wl_data_source_offer(source, "TEXT");
+    wl_data_source_offer(source, "STRING");
+    wl_data_source_offer(source, "UTF8_STRING");
+}
+
+static void
+set_clipboard_data_source(void) {
     struct wl_callback *callback = wl_display_sync(_glfw.wl.display);
     wl_callback_add_listener(callback, &copy_callback_listener, _glfw.wl.dataSourceForClipboard);
 }
 
+void _glfwPlatformSetClipboardString(const char* string)
+{
+    if (!_glfwEnsureDataDevice()) return;
+    free(_glfw.wl.clipboardString);
+    _glfw.wl.clipboardString = _glfw_strdup(string);
+    if (!create_clipboard_data_source()) return;
+    offer_text_mimes(_glfw.wl.dataSourceForClipboard);
+    set_clipboard_data_source();
+}
+
+void _glfwPlatformSetClipboardProvider(void)
+{
+    if (!_glfwEnsureDataDevice()) return;
+    free(_glfw.wl.clipboardString);
+    _glfw.wl.clipboardString = NULL;
+    if (!create_clipboard_data_source()) return;
+    // The data is converted when a paste target asks for it, see _glfwSendClipboardText
+    if (_glfwFindClipboardProviderMime("text/plain;charset=utf-8") >= 0)
+        offer_text_mimes(_glfw.wl.dataSourceForClipboard);
+    for (int i = 0; i < _glfw.clipboardProvider.count; i++) {
+        if (!_glfwIsTextMime(_glfw.clipboardProvider.mimes[i]))
+            wl_data_source_offer(_glfw.wl.dataSourceForClipboard, _glfw.clipboardProvider.mimes[i]);
+    }
+    set_clipboard_data_source();
+}
+
 const char* _glfwPlatformGetClipboardString(void)
 {
     for (size_t i = 0; i < arraysz(_glfw.wl.dataOffers); i++) {
         if (_glfw.wl.dataOffers[i].id && _glfw.wl.dataOffers[i].mime && _glfw.wl.dataOffers[i].offer_type == 1) {
-            if (_glfw.wl.dataOffers[i].is_self_offer) return _glfw.wl.clipboardString;
+            if (_glfw.wl.dataOffers[i].is_self_offer) {
+                size_t size;
+                return get_own_clipboard_data("text/plain;charset=utf-8", &size);
+            }
             return _glfwReceiveClipboardText(_glfw.wl.dataOffers[i].id, _glfw.wl.dataOffers[i].mime);
         }
     }
     return NULL;
 }
 
+GLFWbool _glfwPlatformGetClipboardData(GLFWclipboarddatafun callback, void* user_data)
+{
+    for (size_t i = 0; i < arraysz(_glfw.wl.dataOffers); i++) {
+        const _GLFWWaylandDataOffer *offer = _glfw.wl.dataOffers + i;
+        if (!offer->id || !offer->mime || offer->offer_type != 1) continue;
+        if (offer->is_self_offer) {
+            size_t size;
+            const char *data = get_own_clipboard_data("text/plain;charset=utf-8", &size);
+            if (!data) break;
+            callback(data, size, user_data);
+            return GLFW_TRUE;
+        }
+        return receive_data_offer(offer->id, offer->mime, NULL, callback, user_data);
+    }
+    _glfwInputError(GLFW_FORMAT_UNAVAILABLE, "Wayland: Clipboard contents are not available as text");
+    return GLFW_FALSE;
+}
+
+GLFWbool _glfwPlatformRequestClipboard(_GLFWclipboardrequest* request)
+{
+    const char *mime = request->mime;
+    const GLFWbool is_text = strcmp(mime, "text/plain;charset=utf-8") == 0 || strcmp(mime, "text/plain") == 0;
+    for (size_t i = 0; i < arraysz(_glfw.wl.dataOffers); i++) {
+        const _GLFWWaylandDataOffer *offer = _glfw.wl.dataOffers + i;
+        if (!offer->id || offer->offer_type != 1) continue;
+        if (offer->is_self_offer) {
+            size_t size;
+            const char *contents = get_own_clipboard_data(mime, &size);
+            if (!contents) break;
+            _glfwInputClipboardRequestDone(request, _glfwInputClipboardRequestData(request, contents, size));
+            return GLFW_TRUE;
+        }
+        if (is_text) {
+            if (!offer->mime) break;
+            mime = offer->mime;
+        } else if (!data_offer_has_mime(offer, mime)) break;
+        // The data is read from a non-blocking pipe as it becomes available,
+        // so a slow source does not stall the event loop
+        int pipefd[2];
+        if (pipe2(pipefd, O_CLOEXEC | O_NONBLOCK) != 0) {
+            _glfwInputError(GLFW_PLATFORM_ERROR,
+                "Wayland: Failed to create pipe for clipboard data with error: %s", strerror(errno));
+            return GLFW_FALSE;
+        }
+        wl_data_offer_receive(offer->id, mime, pipefd[1]);
+        close(pipefd[1]);
+        wl_display_flush(_glfw.wl.display);
+        request->fd = pipefd[0];
+        request->watch = addWatch(&_glfw.wl.eventLoopData, "clipboard request", request->fd, POLLIN, 1, read_clipboard_request, request);
+        if (!request->watch) return GLFW_FALSE;
+        request->timer = addTimer(&_glfw.wl.eventLoopData, "clipboard request", 2.0, 1, clipboard_request_timed_out, request);
+        return GLFW_TRUE;
+    }
+    _glfwInputError(GLFW_FORMAT_UNAVAILABLE, "Wayland: Clipboard contents are not available as %s", request->mime);
+    return GLFW_FALSE;
+}
+
 void _glfwPlatformGetRequiredInstanceExtensions(char** extensions)
 {
     if (!_glfw.vk.KHR_surface || !_glfw.vk.KHR_wayland_surface)
@@ -1904,6 +2770,45 @@ GLFWAPI struct wl_surface* glfwGetWaylandWindow(GLFWwindow* handle)
     return window->wl.surface;
 }
 
-GLFWAPI int glfwGetXKBScancode(const char* keyName, GLFWbool caseSensitive) {
+GLFWAPI int glfwGetWaylandClipboardFd(const char* mime, size_t* size)
+{
+    _GLFW_REQUIRE_INIT_OR_RETURN(-1);
+    if (!mime) mime = "text/plain;charset=utf-8";
+    const GLFWbool is_text = strcmp(mime, "text/plain;charset=utf-8") == 0 || strcmp(mime, "text/plain") == 0;
+    for (size_t i = 0; i < arraysz(_glfw.wl.dataOffers); i++) {
+        const _GLFWWaylandDataOffer *offer = _glfw.wl.dataOffers + i;
+        if (!offer->id || offer->offer_type != 1) continue;
+        // Reading our own offer through the compositor would deadlock, so it
+        // is served directly
+        size_t own_size = 0;
+        const char *own = offer->is_self_offer ? get_own_clipboard_data(mime, &own_size) : NULL;
+        if (offer->is_self_offer && !own) break;
+        if (is_text) {
+            if (!offer->mime) break;
+            mime = offer->mime;
+        } else if (!offer->is_self_offer && !data_offer_has_mime(offer, mime)) break;
+        TransferBuffer tb;
+        if (!initTransferBuffer(&tb, 1)) {
+            _glfwInputError(GLFW_PLATFORM_ERROR, "Wayland: Failed to create memfd for clipboard data with error: %s", strerror(errno));
+            return -1;
+        }
+        GLFWbool ok;
+        if (offer->is_self_offer) {
+            ok = writeAll(tb.fd, own, own_size) && finishTransferBuffer(&tb);
+            if (ok) tb.size = own_size;
+            else _glfwInputError(GLFW_PLATFORM_ERROR, "Wayland: Failed to write clipboard data to memfd with error: %s", strerror(errno));
+        } else ok = receive_data_offer(offer->id, mime, &tb, NULL, NULL);
+        if (!ok) {
+            freeTransferBuffer(&tb);
+            return -1;
+        }
+        if (size) *size = tb.size;
+        return tb.fd;
+    }
+    _glfwInputError(GLFW_FORMAT_UNAVAILABLE, "Wayland: Clipboard contents are not available as %s", mime);
+    return -1;
+}
+
+GLFWAPI int glfwGetXKBScancode(const char* keyName, int caseSensitive) {
     return glfw_xkb_keysym_from_name(keyName, caseSensitive);
 }
@@ -28,6 +28,7 @@
 #define _GNU_SOURCE
 #include "internal.h"
 #include "backend_utils.h"
+#include "pixel_convert.h"
 
 #include <X11/Xresource.h>
 
@@ -181,6 +182,10 @@ static GLFWbool initExtensions(void)
             _glfw_dlsym(_glfw.x11.xi.handle, "XIQueryVersion");
         _glfw.x11.xi.SelectEvents = (PFN_XISelectEvents)
             _glfw_dlsym(_glfw.x11.xi.handle, "XISelectEvents");
+        _glfw.x11.xi.QueryDevice = (PFN_XIQueryDevice)
+            _glfw_dlsym(_glfw.x11.xi.handle, "XIQueryDevice");
+        _glfw.x11.xi.FreeDeviceInfo = (PFN_XIFreeDeviceInfo)
+            _glfw_dlsym(_glfw.x11.xi.handle, "XIFreeDeviceInfo");
 
         if (XQueryExtension(_glfw.x11.display,
                             "XInputExtension",
@@ -188,18 +193,48 @@ static GLFWbool initExtensions(void)
                             &_glfw.x11.xi.eventBase,
                             &_glfw.x11.xi.errorBase))
         {
+            // Smooth scrolling is only reported to clients announcing 2.1
             _glfw.x11.xi.major = 2;
-            _glfw.x11.xi.minor = 0;
+            _glfw.x11.xi.minor = 1;
 
             if (XIQueryVersion(_glfw.x11.display,
                                &_glfw.x11.xi.major,
                                &_glfw.x11.xi.minor) == Success)
             {
                 _glfw.x11.xi.available = GLFW_TRUE;
+                _glfw.x11.xi.smoothScroll =
+                    _glfw.x11.xi.QueryDevice && _glfw.x11.xi.FreeDeviceInfo &&
+                    (_glfw.x11.xi.major > 2 || _glfw.x11.xi.minor >= 1);
+                _glfwUpdateScrollValuatorsX11();
             }
         }
     }
 
+#if defined(__CYGWIN__)
+    _glfw.x11.xpresent.handle = _glfw_dlopen("libXpresent-1.so");
+#else
+    _glfw.x11.xpresent.handle = _glfw_dlopen("libXpresent.so.1");
+#endif
+    if (_glfw.x11.xpresent.handle)
+    {
+        _glfw.x11.xpresent.QueryExtension = (PFN_XPresentQueryExtension)
+            _glfw_dlsym(_glfw.x11.xpresent.handle, "XPresentQueryExtension");
+        _glfw.x11.xpresent.SelectInput = (PFN_XPresentSelectInput)
+            _glfw_dlsym(_glfw.x11.xpresent.handle, "XPresentSelectInput");
+        _glfw.x11.xpresent.FreeInput = (PFN_XPresentFreeInput)
+            _glfw_dlsym(_glfw.x11.xpresent.handle, "XPresentFreeInput");
+
+        // This also registers the conversion of Present events with Xlib
+        if (XPresentQueryExtension && XPresentSelectInput && XPresentFreeInput &&
+            XPresentQueryExtension(_glfw.x11.display,
+                                   &_glfw.x11.xpresent.majorOpcode,
+                                   &_glfw.x11.xpresent.eventBase,
+                                   &_glfw.x11.xpresent.errorBase))
+        {
+            _glfw.x11.xpresent.available = GLFW_TRUE;
+        }
+    }
+
 #if defined(__CYGWIN__)
     _glfw.x11.randr.handle = _glfw_dlopen("libXrandr-2.so");
 #else
@@ -391,9 +426,11 @@ static GLFWbool initExtensions(void)
     _glfw.x11.UTF8_STRING = XInternAtom(_glfw.x11.display, "UTF8_STRING", False);
     _glfw.x11.ATOM_PAIR = XInternAtom(_glfw.x11.display, "ATOM_PAIR", False);
 
-    // Custom selection property atom
+    // Custom selection property atoms
     _glfw.x11.GLFW_SELECTION =
         XInternAtom(_glfw.x11.display, "GLFW_SELECTION", False);
+    _glfw.x11.GLFW_CLIPBOARD_REQUEST =
+        XInternAtom(_glfw.x11.display, "GLFW_CLIPBOARD_REQUEST", False);
 
     // ICCCM standard clipboard atoms
     _glfw.x11.TARGETS = XInternAtom(_glfw.x11.display, "TARGETS", False);
@@ -557,6 +594,10 @@ void _glfwReleaseErrorHandlerX11(void)
 {
     // Synchronize to make sure all commands are processed
     XSync(_glfw.x11.display, False);
+#if defined(_GLFW_X11_XCB_EVENTS)
+    // The errors of requests without replies are received as XCB events
+    _glfwReadXCBEventsX11();
+#endif
     XSetErrorHandler(NULL);
 }
 
@@ -575,7 +616,6 @@ void _glfwInputErrorX11(int error, const char* message)
 //
 Cursor _glfwCreateCursorX11(const GLFWimage* image, int xhot, int yhot)
 {
-    int i;
     Cursor cursor;
 
     if (!_glfw.x11.xcursor.handle)
@@ -588,18 +628,8 @@ Cursor _glfwCreateCursorX11(const GLFWimage* image, int xhot, int yhot)
     native->xhot = xhot;
     native->yhot = yhot;
 
-    unsigned char* source = (unsigned char*) image->pixels;
-    XcursorPixel* target = native->pixels;
-
-    for (i = 0;  i < image->width * image->height;  i++, target++, source += 4)
-    {
-        unsigned int alpha = source[3];
-
-        *target = (alpha << 24) |
-                  ((unsigned char) ((source[0] * alpha) / 255) << 16) |
-                  ((unsigned char) ((source[1] * alpha) / 255) <<  8) |
-                  ((unsigned char) ((source[2] * alpha) / 255) <<  0);
-    }
+    premultiplyToARGB32(native->pixels, image->pixels,
+                        (size_t) image->width * image->height);
 
     cursor = XcursorImageLoadCursor(_glfw.x11.display, native);
     XcursorImageDestroy(native);
@@ -616,7 +646,7 @@ int _glfwPlatformInit(void)
     XInitThreads();
     XrmInitialize();
 
-    if (pipe2(_glfw.x11.eventLoopData.wakeupFds, O_CLOEXEC | O_NONBLOCK) != 0)
+    if (!initWakeupFds(&_glfw.x11.eventLoopData))
     {
         _glfwInputError(GLFW_PLATFORM_ERROR,
                 "X11: failed to create self pipe");
@@ -641,12 +671,17 @@ int _glfwPlatformInit(void)
         return GLFW_FALSE;
     }
 
+#if defined(_GLFW_X11_XCB_EVENTS)
+    // Events are read through XCB, see _glfwDispatchX11Events
+    _glfw.x11.xcb.connection = XGetXCBConnection(_glfw.x11.display);
+    XSetEventQueueOwner(_glfw.x11.display, XCBOwnsEventQueue);
+#endif
+
     initPollData(&_glfw.x11.eventLoopData, _glfw.x11.eventLoopData.wakeupFds[0], ConnectionNumber(_glfw.x11.display));
     glfw_dbus_init(&_glfw.x11.dbus, &_glfw.x11.eventLoopData);
 
     _glfw.x11.screen = DefaultScreen(_glfw.x11.display);
     _glfw.x11.root = RootWindow(_glfw.x11.display, _glfw.x11.screen);
-    _glfw.x11.context = XUniqueContext();
     _glfw.x11.RESOURCE_MANAGER = XInternAtom(_glfw.x11.display, "RESOURCE_MANAGER", True);
     XSelectInput(_glfw.x11.display, _glfw.x11.root, PropertyChangeMask);
 
@@ -675,6 +710,10 @@ int _glfwPlatformInit(void)
 
 void _glfwPlatformTerminate(void)
 {
+#if defined(_GLFW_X11_XCB_EVENTS)
+    size_t i;
+#endif
+
     if (_glfw.x11.helperWindowHandle)
     {
         if (XGetSelectionOwner(_glfw.x11.display, _glfw.x11.CLIPBOARD) ==
@@ -683,6 +722,8 @@ void _glfwPlatformTerminate(void)
             _glfwPushSelectionToManagerX11();
         }
 
+        _glfwCancelSelectionTransfersX11(None);
+
         XDestroyWindow(_glfw.x11.display, _glfw.x11.helperWindowHandle);
         _glfw.x11.helperWindowHandle = None;
     }
@@ -697,12 +738,24 @@ void _glfwPlatformTerminate(void)
     glfw_dbus_terminate(&_glfw.x11.dbus);
     free(_glfw.x11.primarySelectionString);
     free(_glfw.x11.clipboardString);
+    _glfwWindowMapFree(&_glfw.x11.windowsByHandle);
+    _glfw.x11.lastEventWindow = NULL;
+
+#if defined(_GLFW_X11_XCB_EVENTS)
+    for (i = _glfw.x11.xcb.head;  i < _glfw.x11.xcb.head + _glfw.x11.xcb.count;  i++)
+    {
+        if (_glfw.x11.xcb.queue[i].type == GenericEvent)
+            XFree(_glfw.x11.xcb.queue[i].xcookie.data);
+    }
+
+    free(_glfw.x11.xcb.queue);
+    memset(&_glfw.x11.xcb, 0, sizeof(_glfw.x11.xcb));
+#endif
 
     if (_glfw.x11.display)
     {
         XCloseDisplay(_glfw.x11.display);
         _glfw.x11.display = NULL;
-        _glfw.x11.eventLoopData.fds[0].fd = -1;
     }
 
     if (_glfw.x11.xcursor.handle)
@@ -741,6 +794,12 @@ void _glfwPlatformTerminate(void)
         _glfw.x11.xi.handle = NULL;
     }
 
+    if (_glfw.x11.xpresent.handle)
+    {
+        _glfw_dlclose(_glfw.x11.xpresent.handle);
+        _glfw.x11.xpresent.handle = NULL;
+    }
+
     // NOTE: These need to be unloaded after XCloseDisplay, as they register
     //       cleanup callbacks that get called by that function
     _glfwTerminateEGL();
@@ -750,6 +809,7 @@ void _glfwPlatformTerminate(void)
     _glfwTerminateJoysticksLinux();
 #endif
     closeFds(_glfw.x11.eventLoopData.wakeupFds, sizeof(_glfw.x11.eventLoopData.wakeupFds)/sizeof(_glfw.x11.eventLoopData.wakeupFds[0]));
+    finalizePollData(&_glfw.x11.eventLoopData);
 }
 
 const char* _glfwPlatformGetVersionString(void)
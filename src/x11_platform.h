@@ -39,6 +39,11 @@
 // The xcb library is needed to work with libxkb
 #include <X11/Xlib-xcb.h>
 
+#if defined(_GLFW_X11_XCB_EVENTS)
+ // The wire format of events, converted to Xlib events when read through XCB
+ struct _xEvent;
+#endif
+
 // The XRandR extension provides mode setting and gamma control
 #include <X11/extensions/Xrandr.h>
 
@@ -115,8 +120,45 @@ typedef Bool (* PFN_XF86VidModeGetGammaRampSize)(Display*,int,int*);
 
 typedef Status (* PFN_XIQueryVersion)(Display*,int*,int*);
 typedef int (* PFN_XISelectEvents)(Display*,Window,XIEventMask*,int);
+typedef XIDeviceInfo* (* PFN_XIQueryDevice)(Display*,int,int*);
+typedef void (* PFN_XIFreeDeviceInfo)(XIDeviceInfo*);
 #define XIQueryVersion _glfw.x11.xi.QueryVersion
 #define XISelectEvents _glfw.x11.xi.SelectEvents
+#define XIQueryDevice _glfw.x11.xi.QueryDevice
+#define XIFreeDeviceInfo _glfw.x11.xi.FreeDeviceInfo
+
+// libXpresent is loaded at run time and the Present extension reports when
+// frames are shown on the display, so neither of their headers is required
+// to build
+#define PresentCompleteNotify 1
+#define PresentCompleteNotifyMask 2
+#define PresentCompleteKindPixmap 0
+#define PresentCompleteModeFlip 1
+#define PresentCompleteModeSkip 2
+
+typedef struct XPresentCompleteNotifyEvent
+{
+    int type;
+    unsigned long serial;
+    Bool send_event;
+    Display* display;
+    int extension;
+    int evtype;
+    XID eid;
+    Window window;
+    uint32_t serial_number;
+    uint64_t ust;
+    uint64_t msc;
+    uint8_t kind;
+    uint8_t mode;
+} XPresentCompleteNotifyEvent;
+
+typedef Bool (* PFN_XPresentQueryExtension)(Display*,int*,int*,int*);
+typedef XID (* PFN_XPresentSelectInput)(Display*,Window,unsigned);
+typedef void (* PFN_XPresentFreeInput)(Display*,Window,XID);
+#define XPresentQueryExtension _glfw.x11.xpresent.QueryExtension
+#define XPresentSelectInput _glfw.x11.xpresent.SelectInput
+#define XPresentFreeInput _glfw.x11.xpresent.FreeInput
 
 typedef Bool (* PFN_XRenderQueryExtension)(Display*,int*,int*);
 typedef Status (* PFN_XRenderQueryVersion)(Display*dpy,int*,int*);
@@ -173,6 +215,7 @@ typedef VkBool32 (APIENTRY *PFN_vkGetPhysicalDeviceXcbPresentationSupportKHR)(Vk
 #define _GLFW_PLATFORM_LIBRARY_WINDOW_STATE _GLFWlibraryX11 x11
 #define _GLFW_PLATFORM_MONITOR_STATE        _GLFWmonitorX11 x11
 #define _GLFW_PLATFORM_CURSOR_STATE         _GLFWcursorX11  x11
+#define _GLFW_PLATFORM_EVENT_LOOP_DATA      _glfw.x11.eventLoopData
 
 
 // X11-specific per-window data
@@ -201,8 +244,44 @@ typedef struct _GLFWwindowX11
     // The time of the last KeyPress event
     Time            lastKeyTime;
 
+    // The Present event selection, and the last completed presentation used
+    // to measure the refresh interval
+    XID             presentEventId;
+    uint64_t        lastPresentUst, lastPresentMsc;
+    double          presentRefresh;
+
 } _GLFWwindowX11;
 
+// Incremental transfer of a selection we own to a requestor (ICCCM section
+// 2.7.2), advanced each time the requestor deletes the property
+//
+typedef struct _GLFWselectiontransferX11
+{
+    struct _GLFWselectiontransferX11* next;
+    Window          requestor;
+    Atom            property;
+    Atom            target;
+    Atom            selection;
+    // The selection data, which outlives the transfer
+    const char*     data;
+    size_t          size;
+    size_t          offset;
+    unsigned long long timer;
+} _GLFWselectiontransferX11;
+
+// Scroll valuator of a master pointer (XI 2.1), whose changes are reported as
+// smooth scrolling
+//
+typedef struct _GLFWscrollvaluatorX11
+{
+    int             deviceid;
+    int             number;
+    GLFWbool        horizontal;
+    // The change in value of one scroll wheel step
+    double          increment;
+    double          value;
+} _GLFWscrollvaluatorX11;
+
 // X11-specific global data
 //
 typedef struct _GLFWlibraryX11
@@ -217,14 +296,19 @@ typedef struct _GLFWlibraryX11
     Window          helperWindowHandle;
     // Invisible cursor for hidden cursor mode
     Cursor          hiddenCursorHandle;
-    // Context for mapping window XIDs to _GLFWwindow pointers
-    XContext        context;
+    // Map from window XIDs to _GLFWwindow pointers
+    _GLFWwindowmap  windowsByHandle;
+    // The window of the most recent window lookup, as nearly all events
+    // are for the same window
+    _GLFWwindow*    lastEventWindow;
     // Most recent error code received by X error handler
     int             errorCode;
     // Primary selection string (while the primary selection is owned)
     char*           primarySelectionString;
     // Clipboard string (while the selection is owned)
     char*           clipboardString;
+    // Incremental transfers of the selections in progress
+    _GLFWselectiontransferX11* selectionTransfers;
     // Where to place the cursor when re-enabled
     double          restoreCursorPosX, restoreCursorPosY;
     // The window whose disabled cursor mode is active
@@ -281,6 +365,7 @@ typedef struct _GLFWlibraryX11
     Atom            COMPOUND_STRING;
     Atom            ATOM_PAIR;
     Atom            GLFW_SELECTION;
+    Atom            GLFW_CLIPBOARD_REQUEST;
 
     // XRM database atom
     Atom            RESOURCE_MANAGER;
@@ -366,10 +451,27 @@ typedef struct _GLFWlibraryX11
         int         errorBase;
         int         major;
         int         minor;
+        // Whether the server reports smooth scrolling (XI 2.1)
+        GLFWbool    smoothScroll;
+        _GLFWscrollvaluatorX11 scrollValuators[16];
+        int         scrollValuatorCount;
         PFN_XIQueryVersion QueryVersion;
         PFN_XISelectEvents SelectEvents;
+        PFN_XIQueryDevice QueryDevice;
+        PFN_XIFreeDeviceInfo FreeDeviceInfo;
     } xi;
 
+    struct {
+        GLFWbool    available;
+        void*       handle;
+        int         majorOpcode;
+        int         eventBase;
+        int         errorBase;
+        PFN_XPresentQueryExtension QueryExtension;
+        PFN_XPresentSelectInput SelectInput;
+        PFN_XPresentFreeInput FreeInput;
+    } xpresent;
+
     struct {
         GLFWbool    available;
         void*       handle;
@@ -382,6 +484,25 @@ typedef struct _GLFWlibraryX11
         PFN_XRenderFindVisualFormat FindVisualFormat;
     } xrender;
 
+#if defined(_GLFW_X11_XCB_EVENTS)
+    struct {
+        // The connection of the display, which owns its event queue
+        xcb_connection_t* connection;
+        // Events read while waiting for a specific event, which are
+        // dispatched before those still unread. Events [head, head + count)
+        // are queued.
+        XEvent*     queue;
+        size_t      head;
+        size_t      count;
+        size_t      capacity;
+        // The Xlib converters of core and extension events by type, and of
+        // generic events by extension opcode, looked up the first time an
+        // event needing them is received
+        Bool        (*wireToEvent[128])(Display*, XEvent*, struct _xEvent*);
+        Bool        (*wireToEventCookie[128])(Display*, XGenericEventCookie*, struct _xEvent*);
+    } xcb;
+#endif
+
     EventLoopData eventLoopData;
 
 } _GLFWlibraryX11;
@@ -426,3 +547,8 @@ void _glfwInputErrorX11(int error, const char* message);
 
 void _glfwGetSystemContentScaleX11(float* xscale, float* yscale, GLFWbool bypass_cache);
 void _glfwPushSelectionToManagerX11(void);
+void _glfwCancelSelectionTransfersX11(Atom selection);
+void _glfwUpdateScrollValuatorsX11(void);
+#if defined(_GLFW_X11_XCB_EVENTS)
+void _glfwReadXCBEventsX11(void);
+#endif
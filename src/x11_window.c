@@ -28,10 +28,16 @@
 #define _GNU_SOURCE
 #include "internal.h"
 #include "backend_utils.h"
+#include "pixel_convert.h"
 
 #include <X11/cursorfont.h>
 #include <X11/Xmd.h>
 
+#if defined(_GLFW_X11_XCB_EVENTS)
+ // The wire to event converters of Xlib and its extensions
+ #include <X11/Xlibint.h>
+#endif
+
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -84,6 +90,249 @@ waitForX11Event(double timeout) {
     }
 }
 
+#if defined(_GLFW_X11_XCB_EVENTS)
+
+// Reports an X error received as an XCB event to the current Xlib error
+// handler, as Xlib does for the errors it receives itself
+//
+static void inputXCBError(const xcb_generic_error_t* error)
+{
+    XErrorEvent event;
+    const XErrorHandler handler = XSetErrorHandler(NULL);
+    XSetErrorHandler(handler);
+
+    memset(&event, 0, sizeof(event));
+    event.type = 0;
+    event.display = _glfw.x11.display;
+    event.resourceid = error->resource_id;
+    event.serial = error->full_sequence;
+    event.error_code = error->error_code;
+    event.request_code = error->major_code;
+    event.minor_code = error->minor_code;
+
+    handler(_glfw.x11.display, &event);
+}
+
+// Converts an XCB event to an Xlib event with the converter registered by Xlib
+// or the extension the event belongs to
+//
+static GLFWbool convertXCBEvent(xcb_generic_event_t* source, XEvent* event)
+{
+    const int type = source->response_type & 0x7f;
+    Bool result;
+
+    memset(event, 0, sizeof(XEvent));
+
+    if (type == GenericEvent)
+    {
+        xcb_ge_generic_event_t* ge = (xcb_ge_generic_event_t*) source;
+        Bool (**convert)(Display*, XGenericEventCookie*, xEvent*) =
+            &_glfw.x11.xcb.wireToEventCookie[ge->extension & 0x7f];
+
+        // Xlib can only be asked for a converter by replacing it
+        if (!*convert)
+        {
+            *convert = XESetWireToEventCookie(_glfw.x11.display, ge->extension, NULL);
+            XESetWireToEventCookie(_glfw.x11.display, ge->extension, *convert);
+            if (!*convert)
+                return GLFW_FALSE;
+        }
+
+        // XCB inserts the full sequence number between the first 32 bytes
+        // and the rest of the event, which Xlib expects to be contiguous
+        memmove(&ge->full_sequence, ge + 1, ge->length * 4);
+
+        // The converters update the display and expect it to be locked.
+        // Unlike with Xlib, the data of the cookie is owned by the event
+        XLockDisplay(_glfw.x11.display);
+        result = (*convert)(_glfw.x11.display, &event->xcookie, (xEvent*) ge);
+        XUnlockDisplay(_glfw.x11.display);
+        return result;
+    }
+    else
+    {
+        Bool (**convert)(Display*, XEvent*, xEvent*) =
+            &_glfw.x11.xcb.wireToEvent[type];
+
+        if (!*convert)
+        {
+            *convert = XESetWireToEvent(_glfw.x11.display, type, NULL);
+            XESetWireToEvent(_glfw.x11.display, type, *convert);
+            if (!*convert)
+                return GLFW_FALSE;
+        }
+
+        XLockDisplay(_glfw.x11.display);
+        result = (*convert)(_glfw.x11.display, event, (xEvent*) source);
+        XUnlockDisplay(_glfw.x11.display);
+        return result;
+    }
+}
+
+// Appends an event read from XCB to the events to be dispatched before those
+// still unread
+//
+static void queueXCBEvent(xcb_generic_event_t* source)
+{
+    XEvent event;
+
+    if (source->response_type == 0)
+    {
+        inputXCBError((xcb_generic_error_t*) source);
+        return;
+    }
+
+    if (!convertXCBEvent(source, &event))
+        return;
+
+    // Moving the queued events down only pays off once at least as many
+    // have been dispatched as are still queued, otherwise the queue grows
+    if (_glfw.x11.xcb.head + _glfw.x11.xcb.count == _glfw.x11.xcb.capacity &&
+        _glfw.x11.xcb.head >= _glfw.x11.xcb.count)
+    {
+        memmove(_glfw.x11.xcb.queue,
+                _glfw.x11.xcb.queue + _glfw.x11.xcb.head,
+                _glfw.x11.xcb.count * sizeof(XEvent));
+        _glfw.x11.xcb.head = 0;
+    }
+
+    if (_glfw.x11.xcb.head + _glfw.x11.xcb.count == _glfw.x11.xcb.capacity)
+    {
+        const size_t capacity = _glfw.x11.xcb.capacity ? _glfw.x11.xcb.capacity * 2 : 64;
+        XEvent* queue = realloc(_glfw.x11.xcb.queue, capacity * sizeof(XEvent));
+        if (!queue)
+        {
+            _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+            if (event.type == GenericEvent)
+                XFree(event.xcookie.data);
+            return;
+        }
+
+        _glfw.x11.xcb.queue = queue;
+        _glfw.x11.xcb.capacity = capacity;
+    }
+
+    _glfw.x11.xcb.queue[_glfw.x11.xcb.head + _glfw.x11.xcb.count++] = event;
+}
+
+// Removes the event at the specified position in the queue, where only
+// removing one other than the first moves the events after it
+//
+static void dequeueXCBEvent(size_t index, XEvent* event)
+{
+    XEvent* queue = _glfw.x11.xcb.queue + _glfw.x11.xcb.head;
+
+    *event = queue[index];
+
+    if (index == 0)
+        _glfw.x11.xcb.head++;
+    else
+    {
+        memmove(queue + index,
+                queue + index + 1,
+                (_glfw.x11.xcb.count - index - 1) * sizeof(XEvent));
+    }
+
+    if (!--_glfw.x11.xcb.count)
+        _glfw.x11.xcb.head = 0;
+}
+
+// Moves all events available from XCB to the queue, where the events being
+// waited for can be looked for without dispatching the others
+//
+void _glfwReadXCBEventsX11(void)
+{
+    xcb_generic_event_t* event;
+
+    XFlush(_glfw.x11.display);
+
+    while ((event = xcb_poll_for_event(_glfw.x11.xcb.connection)))
+    {
+        queueXCBEvent(event);
+        free(event);
+    }
+}
+
+#endif // _GLFW_X11_XCB_EVENTS
+
+// Removes and returns the first received event matching the predicate, if any
+//
+static Bool checkIfEvent(XEvent* event,
+                         Bool (*predicate)(Display*, XEvent*, XPointer),
+                         XPointer pointer)
+{
+#if defined(_GLFW_X11_XCB_EVENTS)
+    size_t i;
+
+    _glfwReadXCBEventsX11();
+
+    for (i = 0;  i < _glfw.x11.xcb.count;  i++)
+    {
+        if (predicate(_glfw.x11.display, _glfw.x11.xcb.queue + _glfw.x11.xcb.head + i, pointer))
+        {
+            dequeueXCBEvent(i, event);
+            return True;
+        }
+    }
+
+    return False;
+#else
+    return XCheckIfEvent(_glfw.x11.display, event, predicate, pointer);
+#endif
+}
+
+// Returns the next received event without removing it, if there is one
+//
+static GLFWbool peekEvent(XEvent* event)
+{
+#if defined(_GLFW_X11_XCB_EVENTS)
+    _glfwReadXCBEventsX11();
+
+    if (!_glfw.x11.xcb.count)
+        return GLFW_FALSE;
+
+    *event = _glfw.x11.xcb.queue[_glfw.x11.xcb.head];
+    return GLFW_TRUE;
+#else
+    if (!XEventsQueued(_glfw.x11.display, QueuedAfterReading))
+        return GLFW_FALSE;
+
+    XPeekEvent(_glfw.x11.display, event);
+    return GLFW_TRUE;
+#endif
+}
+
+// Fetches the data of an XI2 event
+//
+static Bool getEventData(XGenericEventCookie* cookie)
+{
+#if defined(_GLFW_X11_XCB_EVENTS)
+    // Events converted from XCB already carry their data
+    return cookie->data != NULL;
+#else
+    return XGetEventData(_glfw.x11.display, cookie);
+#endif
+}
+
+// Frees the data of an XI2 event
+//
+static void freeEventData(XGenericEventCookie* cookie)
+{
+#if defined(_GLFW_X11_XCB_EVENTS)
+    XFree(cookie->data);
+    cookie->data = NULL;
+#else
+    XFreeEventData(_glfw.x11.display, cookie);
+#endif
+}
+
+static Bool isVisibilityNotify(Display* display, XEvent* event, XPointer pointer)
+{
+    _GLFWwindow* window = (_GLFWwindow*) pointer;
+    return event->type == VisibilityNotify &&
+           event->xvisibility.window == window->x11.handle;
+}
+
 // Waits until a VisibilityNotify event arrives for the specified window or the
 // timeout period elapses (ICCCM section 4.2.2)
 //
@@ -91,10 +340,7 @@ static GLFWbool waitForVisibilityNotify(_GLFWwindow* window)
 {
     XEvent dummy;
 
-    while (!XCheckTypedWindowEvent(_glfw.x11.display,
-                                   window->x11.handle,
-                                   VisibilityNotify,
-                                   &dummy))
+    while (!checkIfEvent(&dummy, isVisibilityNotify, (XPointer) window))
     {
         if (!waitForX11Event(0.1))
             return GLFW_FALSE;
@@ -127,10 +373,31 @@ static int getWindowState(_GLFWwindow* window)
     return result;
 }
 
+// Returns the incremental selection transfer using the property, if any
+//
+static _GLFWselectiontransferX11* findSelectionTransfer(Window requestor, Atom property)
+{
+    _GLFWselectiontransferX11* transfer;
+
+    for (transfer = _glfw.x11.selectionTransfers;  transfer;  transfer = transfer->next)
+    {
+        if (transfer->requestor == requestor && transfer->property == property)
+            return transfer;
+    }
+
+    return NULL;
+}
+
 // Returns whether the event is a selection event
 //
 static Bool isSelectionEvent(Display* display, XEvent* event, XPointer pointer)
 {
+    if (event->type == PropertyNotify)
+    {
+        return findSelectionTransfer(event->xproperty.window,
+                                     event->xproperty.atom) != NULL;
+    }
+
     if (event->xany.window != _glfw.x11.helperWindowHandle)
         return False;
 
@@ -161,6 +428,23 @@ static Bool isSelPropNewValueNotify(Display* display, XEvent* event, XPointer po
            event->xproperty.atom == notification->xselection.property;
 }
 
+// Returns the window with the specified handle, or NULL if it is not one of
+// ours or has been destroyed
+//
+static _GLFWwindow* findWindowByHandle(Window handle)
+{
+    _GLFWwindow* window = _glfw.x11.lastEventWindow;
+
+    if (window && window->x11.handle == handle)
+        return window;
+
+    window = _glfwWindowMapFind(&_glfw.x11.windowsByHandle, handle);
+    if (window)
+        _glfw.x11.lastEventWindow = window;
+
+    return window;
+}
+
 // Translates an X event modifier state mask
 //
 static int translateState(int state)
@@ -382,23 +666,27 @@ static size_t encodeUTF8(char* s, unsigned int ch)
     return count;
 }
 
-// Convert the specified Latin-1 string to UTF-8
+// Passes the specified chunk of Latin-1 text to the callback as UTF-8
 //
-static char* convertLatin1toUTF8(const char* source)
+static void convertLatin1toUTF8(const char* source, size_t size,
+                                GLFWclipboarddatafun callback, void* user_data)
 {
-    size_t size = 1;
-    const char* sp;
-
-    for (sp = source;  *sp;  sp++)
-        size += (*sp & 0x80) ? 2 : 1;
+    char target[4096];
+    size_t i, length = 0;
 
-    char* target = calloc(size, 1);
-    char* tp = target;
+    for (i = 0;  i < size;  i++)
+    {
+        if (length + 2 > sizeof(target))
+        {
+            callback(target, length, user_data);
+            length = 0;
+        }
 
-    for (sp = source;  *sp;  sp++)
-        tp += encodeUTF8(tp, *sp);
+        length += encodeUTF8(target + length, (unsigned char) source[i]);
+    }
 
-    return target;
+    if (length)
+        callback(target, length, user_data);
 }
 
 // Centers the cursor over the window client area
@@ -543,10 +831,31 @@ static GLFWbool createNativeWindow(_GLFWwindow* window,
             return GLFW_FALSE;
         }
 
-        XSaveContext(_glfw.x11.display,
-                     window->x11.handle,
-                     _glfw.x11.context,
-                     (XPointer) window);
+        if (!_glfwWindowMapInsert(&_glfw.x11.windowsByHandle,
+                                  window->x11.handle,
+                                  window))
+        {
+            return GLFW_FALSE;
+        }
+    }
+
+    if (_glfw.x11.xi.available)
+    {
+        // Pointer input is received through XI2 for its sub-pixel positions
+        // and smooth scrolling, which also stops the server from sending the
+        // equivalent core events
+        XIEventMask em;
+        unsigned char mask[XIMaskLen(XI_LASTEVENT)] = { 0 };
+
+        em.deviceid = XIAllMasterDevices;
+        em.mask_len = sizeof(mask);
+        em.mask = mask;
+        XISetMask(mask, XI_Motion);
+        XISetMask(mask, XI_ButtonPress);
+        XISetMask(mask, XI_ButtonRelease);
+        XISetMask(mask, XI_DeviceChanged);
+
+        XISelectEvents(_glfw.x11.display, window->x11.handle, &em, 1);
     }
 
     if (!wndconfig->decorated)
@@ -676,144 +985,390 @@ static GLFWbool createNativeWindow(_GLFWwindow* window,
     return GLFW_TRUE;
 }
 
-// Set the specified property to the selection converted to the requested target
+// Returns the largest amount of selection data written in a single request
 //
-static Atom writeTargetToProperty(const XSelectionRequestEvent* request)
+static size_t getSelectionChunkSize(void)
 {
-    int i;
-    char* selectionString = NULL;
-    const Atom formats[] = { _glfw.x11.UTF8_STRING, XA_STRING };
-    const int formatCount = sizeof(formats) / sizeof(formats[0]);
+    size_t size;
+    long maxRequestSize = XExtendedMaxRequestSize(_glfw.x11.display);
+    if (!maxRequestSize)
+        maxRequestSize = XMaxRequestSize(_glfw.x11.display);
+
+    // The maximum is in four byte units and includes the request header, and
+    // chunks are kept moderate so that one transfer does not hog the server
+    size = (size_t) maxRequestSize * 4 - 256;
+    return size < 262144 ? size : 262144;
+}
 
-    if (request->selection == _glfw.x11.PRIMARY)
-        selectionString = _glfw.x11.primarySelectionString;
-    else
-        selectionString = _glfw.x11.clipboardString;
+// Returns whether the window is one of ours, whose event mask must be left
+// alone by selection transfers
+//
+static GLFWbool isOwnWindow(Window handle)
+{
+    return handle == _glfw.x11.helperWindowHandle ||
+           findWindowByHandle(handle) != NULL;
+}
 
-    if (request->property == None)
-    {
-        // The requester is a legacy client (ICCCM section 2.2)
-        // We don't support legacy clients, so fail here
-        return None;
-    }
+static void freeSelectionTransfer(_GLFWselectiontransferX11* transfer)
+{
+    _GLFWselectiontransferX11** prev = &_glfw.x11.selectionTransfers;
 
-    if (request->target == _glfw.x11.TARGETS)
-    {
-        // The list of supported targets was requested
+    while (*prev != transfer)
+        prev = &((*prev)->next);
 
-        const Atom targets[] = { _glfw.x11.TARGETS,
-                                 _glfw.x11.MULTIPLE,
-                                 _glfw.x11.UTF8_STRING,
-                                 XA_STRING };
+    *prev = transfer->next;
 
-        XChangeProperty(_glfw.x11.display,
-                        request->requestor,
-                        request->property,
-                        XA_ATOM,
-                        32,
-                        PropModeReplace,
-                        (unsigned char*) targets,
-                        sizeof(targets) / sizeof(targets[0]));
+    if (transfer->timer)
+        removeTimer(&_glfw.x11.eventLoopData, transfer->timer);
 
-        return request->property;
+    // Stop listening to the requestor once none of its transfers remain
+    {
+        _GLFWselectiontransferX11* other;
+
+        for (other = _glfw.x11.selectionTransfers;  other;  other = other->next)
+        {
+            if (other->requestor == transfer->requestor)
+                break;
+        }
+
+        if (!other && !isOwnWindow(transfer->requestor))
+        {
+            _glfwGrabErrorHandlerX11();
+            XSelectInput(_glfw.x11.display, transfer->requestor, NoEventMask);
+            _glfwReleaseErrorHandlerX11();
+        }
     }
 
-    if (request->target == _glfw.x11.MULTIPLE)
-    {
-        // Multiple conversions were requested
+    free(transfer);
+}
 
-        Atom* targets;
-        unsigned long i, count;
+static void selectionTransferTimedOut(id_type timer_id, void* data)
+{
+    _glfwInputError(GLFW_PLATFORM_ERROR,
+                    "X11: Timed out sending the selection");
+    freeSelectionTransfer(data);
+}
 
-        count = _glfwGetWindowPropertyX11(request->requestor,
-                                          request->property,
-                                          _glfw.x11.ATOM_PAIR,
-                                          (unsigned char**) &targets);
+// Writes the next chunk of an incremental selection transfer, returning
+// whether the transfer is still in progress
+//
+static GLFWbool writeSelectionChunk(_GLFWselectiontransferX11* transfer)
+{
+    size_t size = transfer->size - transfer->offset;
+    if (size > getSelectionChunkSize())
+        size = getSelectionChunkSize();
+
+    // The requestor may have been destroyed meanwhile
+    _glfwGrabErrorHandlerX11();
+    XChangeProperty(_glfw.x11.display,
+                    transfer->requestor,
+                    transfer->property,
+                    transfer->target,
+                    8,
+                    PropModeReplace,
+                    (unsigned char*) transfer->data + transfer->offset,
+                    (int) size);
+    _glfwReleaseErrorHandlerX11();
 
-        for (i = 0;  i < count;  i += 2)
-        {
-            int j;
+    if (_glfw.x11.errorCode != Success)
+        return GLFW_FALSE;
 
-            for (j = 0;  j < formatCount;  j++)
-            {
-                if (targets[i] == formats[j])
-                    break;
-            }
+    // The transfer ends with an empty chunk
+    transfer->offset += size;
+    return size > 0;
+}
 
-            if (j < formatCount)
-            {
-                XChangeProperty(_glfw.x11.display,
-                                request->requestor,
-                                targets[i + 1],
-                                targets[i],
-                                8,
-                                PropModeReplace,
-                                (unsigned char *) selectionString,
-                                strlen(selectionString));
-            }
-            else
-                targets[i + 1] = None;
-        }
+// Handles the deletion of a property used by an incremental selection
+// transfer, returning whether the event belonged to one
+//
+static GLFWbool handleSelectionTransferEvent(const XEvent* event)
+{
+    _GLFWselectiontransferX11* transfer =
+        findSelectionTransfer(event->xproperty.window, event->xproperty.atom);
+    if (!transfer)
+        return GLFW_FALSE;
 
-        XChangeProperty(_glfw.x11.display,
-                        request->requestor,
-                        request->property,
-                        _glfw.x11.ATOM_PAIR,
-                        32,
-                        PropModeReplace,
-                        (unsigned char*) targets,
-                        count);
+    // Our own writes to the property are reported as well
+    if (event->xproperty.state != PropertyDelete)
+        return GLFW_TRUE;
 
-        XFree(targets);
+    if (writeSelectionChunk(transfer))
+        toggleTimer(&_glfw.x11.eventLoopData, transfer->timer, 1);
+    else
+        freeSelectionTransfer(transfer);
 
-        return request->property;
-    }
+    return GLFW_TRUE;
+}
 
-    if (request->target == _glfw.x11.SAVE_TARGETS)
-    {
-        // The request is a check whether we support SAVE_TARGETS
-        // It should be handled as a no-op side effect target
+// Writes the selection data to the property, or starts an incremental
+// transfer of it if it does not fit in a single request, returning whether
+// the request can be answered
+//
+static GLFWbool writeSelectionData(const XSelectionRequestEvent* request,
+                                   Atom property,
+                                   Atom target,
+                                   const char* data,
+                                   size_t size)
+{
+    _GLFWselectiontransferX11* transfer;
+    long length = (long) size;
 
+    if (size <= getSelectionChunkSize())
+    {
         XChangeProperty(_glfw.x11.display,
                         request->requestor,
-                        request->property,
-                        _glfw.x11.NULL_,
-                        32,
+                        property,
+                        target,
+                        8,
                         PropModeReplace,
-                        NULL,
-                        0);
-
-        return request->property;
+                        (unsigned char*) data,
+                        (int) size);
+        return GLFW_TRUE;
     }
 
-    // Conversion to a data target was requested
+    // A property reused by the requestor replaces its unfinished transfer
+    transfer = findSelectionTransfer(request->requestor, property);
+    if (transfer)
+        freeSelectionTransfer(transfer);
 
-    for (i = 0;  i < formatCount;  i++)
+    transfer = calloc(1, sizeof(_GLFWselectiontransferX11));
+    if (!transfer)
     {
-        if (request->target == formats[i])
-        {
-            // The requested target is one we support
+        _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+        return GLFW_FALSE;
+    }
 
-            XChangeProperty(_glfw.x11.display,
-                            request->requestor,
-                            request->property,
-                            request->target,
-                            8,
-                            PropModeReplace,
-                            (unsigned char *) selectionString,
-                            strlen(selectionString));
+    transfer->requestor = request->requestor;
+    transfer->property = property;
+    transfer->target = target;
+    transfer->selection = request->selection;
+    transfer->data = data;
+    transfer->size = size;
+    transfer->next = _glfw.x11.selectionTransfers;
+    _glfw.x11.selectionTransfers = transfer;
+
+    // The requestor starts the transfer by deleting the property, which we
+    // need to be notified of, as we already are for our own windows
+    _glfwGrabErrorHandlerX11();
+    if (!isOwnWindow(request->requestor))
+        XSelectInput(_glfw.x11.display, request->requestor, PropertyChangeMask);
+    XChangeProperty(_glfw.x11.display,
+                    request->requestor,
+                    property,
+                    _glfw.x11.INCR,
+                    32,
+                    PropModeReplace,
+                    (unsigned char*) &length,
+                    1);
+    _glfwReleaseErrorHandlerX11();
 
-            return request->property;
-        }
+    if (_glfw.x11.errorCode != Success)
+    {
+        freeSelectionTransfer(transfer);
+        return GLFW_FALSE;
     }
 
-    // The requested target is not supported
-
-    return None;
+    transfer->timer = addTimer(&_glfw.x11.eventLoopData,
+                               "selection transfer", 2.0, 1,
+                               selectionTransferTimedOut, transfer);
+    return GLFW_TRUE;
 }
 
-static void handleSelectionClear(XEvent* event)
+// Returns the contents of the clipboard we own in the MIME type, or NULL if
+// they are not available in it
+//
+static const char* getOwnClipboardData(const char* mime, size_t* size)
+{
+    if (_glfw.x11.clipboardString)
+    {
+        if (!_glfwIsTextMime(mime))
+            return NULL;
+
+        *size = strlen(_glfw.x11.clipboardString);
+        return _glfw.x11.clipboardString;
+    }
+
+    return _glfwGetClipboardProviderData(mime, size);
+}
+
+// Returns the selection converted to the target, or NULL if the target is not
+// supported
+//
+static const char* getSelectionData(Atom selection, Atom target, size_t* size)
+{
+    const char* data;
+    char* name;
+
+    if (selection == _glfw.x11.PRIMARY)
+    {
+        if (!_glfw.x11.primarySelectionString ||
+            (target != _glfw.x11.UTF8_STRING && target != XA_STRING))
+        {
+            return NULL;
+        }
+
+        *size = strlen(_glfw.x11.primarySelectionString);
+        return _glfw.x11.primarySelectionString;
+    }
+
+    if (target == _glfw.x11.UTF8_STRING || target == XA_STRING)
+        return getOwnClipboardData("text/plain;charset=utf-8", size);
+
+    // Other targets are named after the MIME type they request
+    name = XGetAtomName(_glfw.x11.display, target);
+    if (!name)
+        return NULL;
+
+    data = getOwnClipboardData(name, size);
+    XFree(name);
+    return data;
+}
+
+// Set the specified property to the selection converted to the requested target
+//
+static Atom writeTargetToProperty(const XSelectionRequestEvent* request)
+{
+    const char* data;
+    size_t size;
+
+    if (request->property == None)
+    {
+        // The requester is a legacy client (ICCCM section 2.2)
+        // We don't support legacy clients, so fail here
+        return None;
+    }
+
+    if (request->target == _glfw.x11.TARGETS)
+    {
+        // The list of supported targets was requested
+
+        const Atom defaultTargets[] = { _glfw.x11.TARGETS,
+                                        _glfw.x11.MULTIPLE,
+                                        _glfw.x11.UTF8_STRING,
+                                        XA_STRING };
+        const int defaultCount = sizeof(defaultTargets) / sizeof(defaultTargets[0]);
+        Atom* targets = (Atom*) defaultTargets;
+        int count = defaultCount;
+
+        if (request->selection == _glfw.x11.CLIPBOARD &&
+            !_glfw.x11.clipboardString)
+        {
+            // The offered types of the clipboard provider, plus the text
+            // targets if one of them is text
+            targets = calloc(_glfw.clipboardProvider.count + defaultCount,
+                             sizeof(Atom));
+            if (!targets)
+            {
+                _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+                return None;
+            }
+
+            memcpy(targets, defaultTargets, 2 * sizeof(Atom));
+            count = 2;
+
+            if (_glfwFindClipboardProviderMime("UTF8_STRING") >= 0)
+            {
+                targets[count++] = _glfw.x11.UTF8_STRING;
+                targets[count++] = XA_STRING;
+            }
+
+            if (_glfw.clipboardProvider.count)
+            {
+                XInternAtoms(_glfw.x11.display,
+                             _glfw.clipboardProvider.mimes,
+                             _glfw.clipboardProvider.count,
+                             False,
+                             targets + count);
+                count += _glfw.clipboardProvider.count;
+            }
+        }
+
+        XChangeProperty(_glfw.x11.display,
+                        request->requestor,
+                        request->property,
+                        XA_ATOM,
+                        32,
+                        PropModeReplace,
+                        (unsigned char*) targets,
+                        count);
+
+        if (targets != defaultTargets)
+            free(targets);
+
+        return request->property;
+    }
+
+    if (request->target == _glfw.x11.MULTIPLE)
+    {
+        // Multiple conversions were requested
+
+        Atom* targets;
+        unsigned long i, count;
+
+        count = _glfwGetWindowPropertyX11(request->requestor,
+                                          request->property,
+                                          _glfw.x11.ATOM_PAIR,
+                                          (unsigned char**) &targets);
+
+        for (i = 0;  i < count;  i += 2)
+        {
+            data = getSelectionData(request->selection, targets[i], &size);
+            if (!data ||
+                !writeSelectionData(request, targets[i + 1], targets[i], data, size))
+            {
+                targets[i + 1] = None;
+            }
+        }
+
+        XChangeProperty(_glfw.x11.display,
+                        request->requestor,
+                        request->property,
+                        _glfw.x11.ATOM_PAIR,
+                        32,
+                        PropModeReplace,
+                        (unsigned char*) targets,
+                        count);
+
+        XFree(targets);
+
+        return request->property;
+    }
+
+    if (request->target == _glfw.x11.SAVE_TARGETS)
+    {
+        // The request is a check whether we support SAVE_TARGETS
+        // It should be handled as a no-op side effect target
+
+        XChangeProperty(_glfw.x11.display,
+                        request->requestor,
+                        request->property,
+                        _glfw.x11.NULL_,
+                        32,
+                        PropModeReplace,
+                        NULL,
+                        0);
+
+        return request->property;
+    }
+
+    // Conversion to a data target was requested
+
+    data = getSelectionData(request->selection, request->target, &size);
+    if (data &&
+        writeSelectionData(request, request->property, request->target, data, size))
+    {
+        return request->property;
+    }
+
+    // The requested target is not supported or could not be written
+
+    return None;
+}
+
+static void handleSelectionClear(XEvent* event)
 {
+    _glfwCancelSelectionTransfersX11(event->xselectionclear.selection);
+
     if (event->xselectionclear.selection == _glfw.x11.PRIMARY)
     {
         free(_glfw.x11.primarySelectionString);
@@ -823,6 +1378,7 @@ static void handleSelectionClear(XEvent* event)
     {
         free(_glfw.x11.clipboardString);
         _glfw.x11.clipboardString = NULL;
+        _glfwFreeClipboardProvider(&_glfw.clipboardProvider);
     }
 }
 
@@ -844,28 +1400,64 @@ static void handleSelectionRequest(XEvent* event)
     XSendEvent(_glfw.x11.display, request->requestor, False, 0, &reply);
 }
 
-static const char* getSelectionString(Atom selection)
+// Returns whether the event is the reply to the selection conversion request
+// for the selection and target pointed to.  Refusals carry no property, so
+// they are told apart from those to clipboard requests by what they refuse.
+//
+static Bool isSelectionNotify(Display* display, XEvent* event, XPointer pointer)
 {
-    size_t i;
-    char** selectionString = NULL;
-    const Atom targets[] = { _glfw.x11.UTF8_STRING, XA_STRING };
-    const size_t targetCount = sizeof(targets) / sizeof(targets[0]);
+    const Atom* request = (const Atom*) pointer;
+
+    return event->type == SelectionNotify &&
+           event->xselection.requestor == _glfw.x11.helperWindowHandle &&
+           event->xselection.selection == request[0] &&
+           event->xselection.target == request[1] &&
+           (event->xselection.property == _glfw.x11.GLFW_SELECTION ||
+            event->xselection.property == None);
+}
 
-    if (selection == _glfw.x11.PRIMARY)
-        selectionString = &_glfw.x11.primarySelectionString;
-    else
-        selectionString = &_glfw.x11.clipboardString;
+// Waits for an event matching the predicate, giving up if the selection owner
+// makes no progress for two seconds
+//
+static GLFWbool waitForSelectionEvent(XEvent* event,
+                                      Bool (*predicate)(Display*, XEvent*, XPointer),
+                                      XPointer pointer)
+{
+    const double deadline = glfwGetTime() + 2.0;
 
-    if (XGetSelectionOwner(_glfw.x11.display, selection) ==
-        _glfw.x11.helperWindowHandle)
+    while (!checkIfEvent(event, predicate, pointer))
     {
-        // Instead of doing a large number of X round-trips just to put this
-        // string into a window property and then read it back, just return it
-        return *selectionString;
+        const double timeout = deadline - glfwGetTime();
+        if (timeout <= 0.0 || !waitForX11Event(timeout))
+            return GLFW_FALSE;
     }
 
-    free(*selectionString);
-    *selectionString = NULL;
+    return GLFW_TRUE;
+}
+
+// Returns the size in bytes of the data of a window property
+//
+static size_t getPropertySize(int format, unsigned long itemCount)
+{
+    // Xlib returns 16 and 32-bit items as shorts and longs
+    if (format == 16)
+        return itemCount * sizeof(short);
+    if (format == 32)
+        return itemCount * sizeof(long);
+
+    return itemCount;
+}
+
+// Passes the contents of the selection to the callback as they arrive, as
+// UTF-8 text.  Chunks already passed must be discarded if this fails.
+//
+static GLFWbool receiveSelection(Atom selection,
+                                 GLFWclipboarddatafun callback,
+                                 void* user_data)
+{
+    size_t i;
+    const Atom targets[] = { _glfw.x11.UTF8_STRING, XA_STRING };
+    const size_t targetCount = sizeof(targets) / sizeof(targets[0]);
 
     for (i = 0;  i < targetCount;  i++)
     {
@@ -874,6 +1466,7 @@ static const char* getSelectionString(Atom selection)
         int actualFormat;
         unsigned long itemCount, bytesAfter;
         XEvent notification, dummy;
+        const Atom request[] = { selection, targets[i] };
 
         XConvertSelection(_glfw.x11.display,
                           selection,
@@ -882,21 +1475,21 @@ static const char* getSelectionString(Atom selection)
                           _glfw.x11.helperWindowHandle,
                           CurrentTime);
 
-        while (!XCheckTypedWindowEvent(_glfw.x11.display,
-                                       _glfw.x11.helperWindowHandle,
-                                       SelectionNotify,
-                                       &notification))
+        if (!waitForSelectionEvent(&notification,
+                                   isSelectionNotify,
+                                   (XPointer) request))
         {
-            waitForX11Event(-1);
+            _glfwInputError(GLFW_PLATFORM_ERROR,
+                            "X11: Timed out waiting for the selection owner");
+            return GLFW_FALSE;
         }
 
         if (notification.xselection.property == None)
             continue;
 
-        XCheckIfEvent(_glfw.x11.display,
-                      &dummy,
-                      isSelPropNewValueNotify,
-                      (XPointer) &notification);
+        checkIfEvent(&dummy,
+                     isSelPropNewValueNotify,
+                     (XPointer) &notification);
 
         XGetWindowProperty(_glfw.x11.display,
                            notification.xselection.requestor,
@@ -913,20 +1506,22 @@ static const char* getSelectionString(Atom selection)
 
         if (actualType == _glfw.x11.INCR)
         {
-            size_t size = 1;
-            char* string = NULL;
-
+            // The owner sends the data in chunks, each one written to the
+            // property after the previous one was deleted, and ends with an
+            // empty chunk (ICCCM section 2.7.2)
             for (;;)
             {
-                while (!XCheckIfEvent(_glfw.x11.display,
-                                      &dummy,
-                                      isSelPropNewValueNotify,
-                                      (XPointer) &notification))
+                XFree(data);
+
+                if (!waitForSelectionEvent(&dummy,
+                                           isSelPropNewValueNotify,
+                                           (XPointer) &notification))
                 {
-                    waitForX11Event(-1);
+                    _glfwInputError(GLFW_PLATFORM_ERROR,
+                                    "X11: Timed out receiving the selection");
+                    return GLFW_FALSE;
                 }
 
-                XFree(data);
                 XGetWindowProperty(_glfw.x11.display,
                                    notification.xselection.requestor,
                                    notification.xselection.property,
@@ -940,129 +1535,787 @@ static const char* getSelectionString(Atom selection)
                                    &bytesAfter,
                                    (unsigned char**) &data);
 
-                if (itemCount)
+                if (!itemCount)
                 {
-                    size += itemCount;
-                    string = realloc(string, size);
-                    string[size - itemCount - 1] = '\0';
-                    strcat(string, data);
+                    XFree(data);
+                    return GLFW_TRUE;
                 }
 
-                if (!itemCount)
+                if (targets[i] == XA_STRING)
                 {
-                    if (targets[i] == XA_STRING)
-                    {
-                        *selectionString = convertLatin1toUTF8(string);
-                        free(string);
-                    }
-                    else
-                        *selectionString = string;
-
-                    break;
+                    convertLatin1toUTF8(data, getPropertySize(actualFormat, itemCount),
+                                        callback, user_data);
                 }
+                else
+                    callback(data, getPropertySize(actualFormat, itemCount), user_data);
             }
         }
-        else if (actualType == targets[i])
+
+        if (actualType == targets[i])
         {
             if (targets[i] == XA_STRING)
-                *selectionString = convertLatin1toUTF8(data);
+            {
+                convertLatin1toUTF8(data, getPropertySize(actualFormat, itemCount),
+                                    callback, user_data);
+            }
             else
-                *selectionString = _glfw_strdup(data);
+                callback(data, getPropertySize(actualFormat, itemCount), user_data);
+
+            XFree(data);
+            return GLFW_TRUE;
         }
 
         XFree(data);
+    }
 
-        if (*selectionString)
-            break;
+    _glfwInputError(GLFW_FORMAT_UNAVAILABLE,
+                    "X11: Failed to convert selection to string");
+    return GLFW_FALSE;
+}
+
+// Text accumulated by receiveSelection
+//
+typedef struct
+{
+    char*   data;
+    size_t  size;
+    size_t  capacity;
+    GLFWbool failed;
+} SelectionBuffer;
+
+static void appendToSelectionBuffer(const char* data, size_t size, void* user_data)
+{
+    SelectionBuffer* buffer = user_data;
+
+    if (buffer->failed)
+        return;
+
+    // Leave room for the terminating null byte
+    if (buffer->size + size + 1 > buffer->capacity)
+    {
+        size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+        char* grown;
+
+        while (capacity < buffer->size + size + 1)
+            capacity *= 2;
+
+        grown = realloc(buffer->data, capacity);
+        if (!grown)
+        {
+            _glfwInputError(GLFW_OUT_OF_MEMORY, NULL);
+            buffer->failed = GLFW_TRUE;
+            return;
+        }
+
+        buffer->data = grown;
+        buffer->capacity = capacity;
     }
 
-    if (!*selectionString)
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+}
+
+static const char* getSelectionString(Atom selection)
+{
+    char** selectionString = NULL;
+    SelectionBuffer buffer = { NULL, 0, 0, GLFW_FALSE };
+
+    if (selection == _glfw.x11.PRIMARY)
+        selectionString = &_glfw.x11.primarySelectionString;
+    else
+        selectionString = &_glfw.x11.clipboardString;
+
+    if (XGetSelectionOwner(_glfw.x11.display, selection) ==
+        _glfw.x11.helperWindowHandle)
     {
-        _glfwInputError(GLFW_FORMAT_UNAVAILABLE,
-                        "X11: Failed to convert selection to string");
+        // Instead of doing a large number of X round-trips just to put this
+        // string into a window property and then read it back, just return it
+        if (selection == _glfw.x11.CLIPBOARD)
+        {
+            size_t size;
+            return getOwnClipboardData("text/plain;charset=utf-8", &size);
+        }
+
+        return *selectionString;
+    }
+
+    free(*selectionString);
+    *selectionString = NULL;
+
+    if (!receiveSelection(selection, appendToSelectionBuffer, &buffer) ||
+        buffer.failed)
+    {
+        free(buffer.data);
+        return NULL;
+    }
+
+    // An empty selection still needs its null byte
+    appendToSelectionBuffer("", 0, &buffer);
+    if (buffer.failed)
+    {
+        free(buffer.data);
+        return NULL;
     }
 
+    buffer.data[buffer.size] = '\0';
+    *selectionString = buffer.data;
     return *selectionString;
 }
 
-// Make the specified window and its video mode active on its monitor
+// Returns the selection target used to request the MIME type
 //
-static void acquireMonitor(_GLFWwindow* window)
+static Atom getTargetForMime(const char* mime)
 {
-    if (_glfw.x11.saver.count == 0)
+    if (strcmp(mime, "text/plain;charset=utf-8") == 0 ||
+        strcmp(mime, "text/plain") == 0)
     {
-        // Remember old screen saver settings
-        XGetScreenSaver(_glfw.x11.display,
-                        &_glfw.x11.saver.timeout,
-                        &_glfw.x11.saver.interval,
-                        &_glfw.x11.saver.blanking,
-                        &_glfw.x11.saver.exposure);
-
-        // Disable screen saver
-        XSetScreenSaver(_glfw.x11.display, 0, 0, DontPreferBlanking,
-                        DefaultExposures);
+        return _glfw.x11.UTF8_STRING;
     }
 
-    if (!window->monitor->window)
-        _glfw.x11.saver.count++;
+    return XInternAtom(_glfw.x11.display, mime, False);
+}
 
-    _glfwSetVideoModeX11(window->monitor, &window->videoMode);
+static void startClipboardRequests(void);
+
+// Completes the active clipboard request and starts the next one
+//
+static void finishClipboardRequest(GLFWbool succeeded)
+{
+    _glfwInputClipboardRequestDone(_glfw.clipboardRequestListHead, succeeded);
+    startClipboardRequests();
+}
+
+static void clipboardRequestTimedOut(id_type timer_id, void* data)
+{
+    _glfwInputError(GLFW_PLATFORM_ERROR,
+                    "X11: Timed out waiting for the clipboard owner");
+    finishClipboardRequest(GLFW_FALSE);
+}
+
+// Asks the clipboard owner to convert the clipboard to the target of the
+// active request
+//
+static void convertClipboardRequest(_GLFWclipboardrequest* request)
+{
+    XConvertSelection(_glfw.x11.display,
+                      _glfw.x11.CLIPBOARD,
+                      request->target,
+                      _glfw.x11.GLFW_CLIPBOARD_REQUEST,
+                      _glfw.x11.helperWindowHandle,
+                      CurrentTime);
+    XFlush(_glfw.x11.display);
+}
+
+// Clipboard request receiving Latin-1 text through convertLatin1toUTF8
+//
+typedef struct
+{
+    _GLFWclipboardrequest* request;
+    GLFWbool succeeded;
+} Latin1ClipboardRequest;
+
+static void appendLatin1ToClipboardRequest(const char* data, size_t size, void* user_data)
+{
+    Latin1ClipboardRequest* latin1 = user_data;
+
+    if (latin1->succeeded)
+        latin1->succeeded = _glfwInputClipboardRequestData(latin1->request, data, size);
+}
+
+// Passes a chunk of the selection to the active clipboard request, converting
+// it to UTF-8 if it was received as STRING
+//
+static GLFWbool inputClipboardRequestData(_GLFWclipboardrequest* request,
+                                          const char* data, size_t size)
+{
+    Latin1ClipboardRequest latin1 = { request, GLFW_TRUE };
+
+    if (request->target != XA_STRING)
+        return _glfwInputClipboardRequestData(request, data, size);
+
+    convertLatin1toUTF8(data, size, appendLatin1ToClipboardRequest, &latin1);
+    return latin1.succeeded;
+}
+
+// Starts the first pending clipboard request unless it is in progress.  The
+// requests share a property on the helper window, so they are served one at
+// a time, each completing as its events arrive in processEvent.
+//
+static void startClipboardRequests(void)
+{
+    _GLFWclipboardrequest* request;
+
+    while ((request = _glfw.clipboardRequestListHead) && !request->target)
+    {
+        request->target = getTargetForMime(request->mime);
+
+        if (XGetSelectionOwner(_glfw.x11.display, _glfw.x11.CLIPBOARD) ==
+            _glfw.x11.helperWindowHandle)
+        {
+            size_t size;
+            const char* data = getOwnClipboardData(request->mime, &size);
+
+            if (!data)
+            {
+                _glfwInputError(GLFW_FORMAT_UNAVAILABLE,
+                                "X11: Failed to convert selection to %s",
+                                request->mime);
+                _glfwInputClipboardRequestDone(request, GLFW_FALSE);
+            }
+            else
+            {
+                _glfwInputClipboardRequestDone(request,
+                    _glfwInputClipboardRequestData(request, data, size));
+            }
+
+            continue;
+        }
+
+        request->timer = addTimer(&_glfw.x11.eventLoopData,
+                                  "clipboard request", 2.0, 1,
+                                  clipboardRequestTimedOut, NULL);
+        convertClipboardRequest(request);
+    }
+}
+
+// Returns whether the event is the reply to the active clipboard request
+//
+static GLFWbool isClipboardRequestNotify(const XEvent* event)
+{
+    const _GLFWclipboardrequest* request = _glfw.clipboardRequestListHead;
+
+    if (!request || !request->target || request->incremental ||
+        event->xselection.requestor != _glfw.x11.helperWindowHandle)
+    {
+        return GLFW_FALSE;
+    }
+
+    if (event->xselection.property == _glfw.x11.GLFW_CLIPBOARD_REQUEST)
+        return GLFW_TRUE;
+
+    return event->xselection.property == None &&
+           event->xselection.selection == _glfw.x11.CLIPBOARD &&
+           event->xselection.target == request->target;
+}
+
+static void handleClipboardRequestNotify(const XEvent* event)
+{
+    _GLFWclipboardrequest* request = _glfw.clipboardRequestListHead;
+    char* data;
+    Atom actualType;
+    int actualFormat;
+    unsigned long itemCount, bytesAfter;
+    GLFWbool succeeded;
+
+    if (event->xselection.property == None)
+    {
+        // Owners that predate UTF8_STRING may still provide Latin-1 text
+        if (request->target == _glfw.x11.UTF8_STRING)
+        {
+            request->target = XA_STRING;
+            toggleTimer(&_glfw.x11.eventLoopData, request->timer, 1);
+            convertClipboardRequest(request);
+            return;
+        }
+
+        _glfwInputError(GLFW_FORMAT_UNAVAILABLE,
+                        "X11: Failed to convert selection to %s",
+                        request->mime);
+        finishClipboardRequest(GLFW_FALSE);
+        return;
+    }
+
+    XGetWindowProperty(_glfw.x11.display,
+                       _glfw.x11.helperWindowHandle,
+                       _glfw.x11.GLFW_CLIPBOARD_REQUEST,
+                       0,
+                       LONG_MAX,
+                       True,
+                       AnyPropertyType,
+                       &actualType,
+                       &actualFormat,
+                       &itemCount,
+                       &bytesAfter,
+                       (unsigned char**) &data);
+
+    if (actualType == _glfw.x11.INCR)
+    {
+        // Deleting the property above asked the owner for the first chunk,
+        // the rest arrive as PropertyNotify events
+        request->incremental = GLFW_TRUE;
+        toggleTimer(&_glfw.x11.eventLoopData, request->timer, 1);
+        XFree(data);
+        return;
+    }
+
+    succeeded = actualType != None &&
+        inputClipboardRequestData(request, data,
+                                  getPropertySize(actualFormat, itemCount));
+
+    XFree(data);
+    finishClipboardRequest(succeeded);
+}
+
+static void handleClipboardRequestProperty(const XEvent* event)
+{
+    _GLFWclipboardrequest* request = _glfw.clipboardRequestListHead;
+    char* data;
+    Atom actualType;
+    int actualFormat;
+    unsigned long itemCount, bytesAfter;
+
+    if (!request || !request->incremental ||
+        event->xproperty.atom != _glfw.x11.GLFW_CLIPBOARD_REQUEST ||
+        event->xproperty.state != PropertyNewValue)
+    {
+        return;
+    }
+
+    XGetWindowProperty(_glfw.x11.display,
+                       _glfw.x11.helperWindowHandle,
+                       _glfw.x11.GLFW_CLIPBOARD_REQUEST,
+                       0,
+                       LONG_MAX,
+                       True,
+                       AnyPropertyType,
+                       &actualType,
+                       &actualFormat,
+                       &itemCount,
+                       &bytesAfter,
+                       (unsigned char**) &data);
+
+    // The transfer ends with an empty chunk
+    if (!itemCount)
+    {
+        XFree(data);
+        finishClipboardRequest(GLFW_TRUE);
+        return;
+    }
+
+    if (!inputClipboardRequestData(request, data,
+                                   getPropertySize(actualFormat, itemCount)))
+    {
+        XFree(data);
+        finishClipboardRequest(GLFW_FALSE);
+        return;
+    }
+
+    XFree(data);
+    toggleTimer(&_glfw.x11.eventLoopData, request->timer, 1);
+}
+
+// Make the specified window and its video mode active on its monitor
+//
+static void acquireMonitor(_GLFWwindow* window)
+{
+    if (_glfw.x11.saver.count == 0)
+    {
+        // Remember old screen saver settings
+        XGetScreenSaver(_glfw.x11.display,
+                        &_glfw.x11.saver.timeout,
+                        &_glfw.x11.saver.interval,
+                        &_glfw.x11.saver.blanking,
+                        &_glfw.x11.saver.exposure);
+
+        // Disable screen saver
+        XSetScreenSaver(_glfw.x11.display, 0, 0, DontPreferBlanking,
+                        DefaultExposures);
+    }
+
+    if (!window->monitor->window)
+        _glfw.x11.saver.count++;
+
+    _glfwSetVideoModeX11(window->monitor, &window->videoMode);
+
+    if (window->x11.overrideRedirect)
+    {
+        int xpos, ypos;
+        GLFWvidmode mode;
+
+        // Manually position the window over its monitor
+        _glfwPlatformGetMonitorPos(window->monitor, &xpos, &ypos);
+        _glfwPlatformGetVideoMode(window->monitor, &mode);
+
+        XMoveResizeWindow(_glfw.x11.display, window->x11.handle,
+                          xpos, ypos, mode.width, mode.height);
+    }
+
+    _glfwInputMonitorWindow(window->monitor, window);
+}
+
+// Remove the window and restore the original video mode
+//
+static void releaseMonitor(_GLFWwindow* window)
+{
+    if (window->monitor->window != window)
+        return;
+
+    _glfwInputMonitorWindow(window->monitor, NULL);
+    _glfwRestoreVideoModeX11(window->monitor);
+
+    _glfw.x11.saver.count--;
+
+    if (_glfw.x11.saver.count == 0)
+    {
+        // Restore old screen saver settings
+        XSetScreenSaver(_glfw.x11.display,
+                        _glfw.x11.saver.timeout,
+                        _glfw.x11.saver.interval,
+                        _glfw.x11.saver.blanking,
+                        _glfw.x11.saver.exposure);
+    }
+}
+
+static void onConfigChange()
+{
+    float xscale, yscale;
+    _glfwGetSystemContentScaleX11(&xscale, &yscale, GLFW_TRUE);
+
+    if (xscale != _glfw.x11.contentScaleX || yscale != _glfw.x11.contentScaleY)
+    {
+        _GLFWwindow* window = _glfw.windowListHead;
+        _glfw.x11.contentScaleX = xscale;
+        _glfw.x11.contentScaleY = yscale;
+        while (window)
+        {
+            _glfwInputWindowContentScale(window, xscale, yscale);
+            window = window->next;
+        }
+    }
+}
+
+// Reports a mouse button event, where the buttons between the middle button
+// and the extra buttons are the scroll wheel
+//
+static void inputButton(_GLFWwindow* window, unsigned int button, int action, int mods)
+{
+    if (button == Button1)
+        _glfwInputMouseClick(window, GLFW_MOUSE_BUTTON_LEFT, action, mods);
+    else if (button == Button2)
+        _glfwInputMouseClick(window, GLFW_MOUSE_BUTTON_MIDDLE, action, mods);
+    else if (button == Button3)
+        _glfwInputMouseClick(window, GLFW_MOUSE_BUTTON_RIGHT, action, mods);
+
+    // Modern X provides scroll events as mouse button presses
+    else if (button <= Button7)
+    {
+        if (action != GLFW_PRESS)
+            return;
+
+        if (button == Button4)
+            _glfwInputScroll(window, 0.0, 1.0, 0);
+        else if (button == Button5)
+            _glfwInputScroll(window, 0.0, -1.0, 0);
+        else if (button == Button6)
+            _glfwInputScroll(window, 1.0, 0.0, 0);
+        else
+            _glfwInputScroll(window, -1.0, 0.0, 0);
+    }
+
+    else
+    {
+        // Additional buttons after 7 are treated as regular buttons
+        // We subtract 4 to fill the gap left by scroll input above
+        _glfwInputMouseClick(window, button - Button1 - 4, action, mods);
+    }
+}
+
+// Reports a cursor motion event
+//
+static void inputCursorMotion(_GLFWwindow* window, double xpos, double ypos)
+{
+    const int x = (int) xpos;
+    const int y = (int) ypos;
+
+    if (x != window->x11.warpCursorPosX ||
+        y != window->x11.warpCursorPosY)
+    {
+        // The cursor was moved by something other than GLFW
+
+        if (window->cursorMode == GLFW_CURSOR_DISABLED)
+        {
+            if (_glfw.x11.disabledCursorWindow != window)
+                return;
+            if (_glfw.x11.xi.available)
+                return;
+
+            const int dx = x - window->x11.lastCursorPosX;
+            const int dy = y - window->x11.lastCursorPosY;
+
+            _glfwInputCursorPos(window,
+                                window->virtualCursorPosX + dx,
+                                window->virtualCursorPosY + dy);
+        }
+        else
+            _glfwInputCursorPos(window, xpos, ypos);
+    }
+
+    window->x11.lastCursorPosX = x;
+    window->x11.lastCursorPosY = y;
+}
+
+// Reports a change of the window size or position
+//
+static void inputConfigure(_GLFWwindow* window,
+                           int x, int y, int width, int height,
+                           GLFWbool sendEvent)
+{
+    if (width != window->x11.width || height != window->x11.height)
+    {
+        _glfwInputFramebufferSize(window, width, height);
+        _glfwInputWindowSize(window, width, height);
+
+        window->x11.width = width;
+        window->x11.height = height;
+    }
+
+    if (x != window->x11.xpos || y != window->x11.ypos)
+    {
+        // Only synthetic events have root coordinates for reparented windows
+        if (window->x11.overrideRedirect || sendEvent)
+        {
+            _glfwInputWindowPos(window, x, y);
+
+            window->x11.xpos = x;
+            window->x11.ypos = y;
+        }
+    }
+}
+
+// Reads the scroll valuators of the master pointers and their current values,
+// from which the scroll deltas of later motion events are computed
+//
+void _glfwUpdateScrollValuatorsX11(void)
+{
+    XIDeviceInfo* devices;
+    int i, j, k, count;
+
+    _glfw.x11.xi.scrollValuatorCount = 0;
+
+    if (!_glfw.x11.xi.smoothScroll)
+        return;
+
+    devices = XIQueryDevice(_glfw.x11.display, XIAllMasterDevices, &count);
+    if (!devices)
+        return;
+
+    for (i = 0;  i < count;  i++)
+    {
+        if (devices[i].use != XIMasterPointer)
+            continue;
+
+        for (j = 0;  j < devices[i].num_classes;  j++)
+        {
+            const XIScrollClassInfo* scroll =
+                (const XIScrollClassInfo*) devices[i].classes[j];
+            _GLFWscrollvaluatorX11* valuator;
+
+            if (scroll->type != XIScrollClass || scroll->increment == 0.0)
+                continue;
+
+            if (_glfw.x11.xi.scrollValuatorCount ==
+                sizeof(_glfw.x11.xi.scrollValuators) / sizeof(_glfw.x11.xi.scrollValuators[0]))
+            {
+                break;
+            }
+
+            valuator = _glfw.x11.xi.scrollValuators +
+                       _glfw.x11.xi.scrollValuatorCount++;
+            valuator->deviceid = devices[i].deviceid;
+            valuator->number = scroll->number;
+            valuator->horizontal = scroll->scroll_type == XIScrollTypeHorizontal;
+            valuator->increment = scroll->increment;
+            valuator->value = 0.0;
+
+            // The current value is reported by the valuator class of the
+            // same number
+            for (k = 0;  k < devices[i].num_classes;  k++)
+            {
+                const XIValuatorClassInfo* info =
+                    (const XIValuatorClassInfo*) devices[i].classes[k];
+
+                if (info->type == XIValuatorClass && info->number == scroll->number)
+                    valuator->value = info->value;
+            }
+        }
+    }
+
+    XIFreeDeviceInfo(devices);
+}
+
+// Returns whether the scroll valuators of the device along the axis are
+// tracked, in which case its emulated wheel buttons are not reported
+//
+static GLFWbool hasScrollValuator(int deviceid, GLFWbool horizontal)
+{
+    int i;
+
+    for (i = 0;  i < _glfw.x11.xi.scrollValuatorCount;  i++)
+    {
+        const _GLFWscrollvaluatorX11* valuator = _glfw.x11.xi.scrollValuators + i;
+        if (valuator->deviceid == deviceid && valuator->horizontal == horizontal)
+            return GLFW_TRUE;
+    }
+
+    return GLFW_FALSE;
+}
+
+// Reports the changes of scroll valuators in an XI2 motion event as smooth
+// scrolling, in fractional scroll wheel steps like the wheel buttons
+//
+static void inputScrollValuators(_GLFWwindow* window, const XIDeviceEvent* event)
+{
+    const double* values = event->valuators.values;
+    double xoffset = 0.0, yoffset = 0.0;
+    int i, j;
+
+    for (i = 0;  i < event->valuators.mask_len * 8;  i++)
+    {
+        if (!XIMaskIsSet(event->valuators.mask, i))
+            continue;
+
+        for (j = 0;  j < _glfw.x11.xi.scrollValuatorCount;  j++)
+        {
+            _GLFWscrollvaluatorX11* valuator = _glfw.x11.xi.scrollValuators + j;
+            double delta;
+
+            if (valuator->deviceid != event->deviceid || valuator->number != i)
+                continue;
+
+            // Positive values scroll down or right, like buttons 5 and 7
+            delta = (*values - valuator->value) / valuator->increment;
+            if (valuator->horizontal)
+                xoffset -= delta;
+            else
+                yoffset -= delta;
+
+            valuator->value = *values;
+        }
+
+        values++;
+    }
+
+    if (xoffset != 0.0 || yoffset != 0.0)
+        _glfwInputScroll(window, xoffset, yoffset, 0);
+}
+
+// Process the specified XI2 pointer event
+//
+static void processDeviceEvent(int type, const XIDeviceEvent* event)
+{
+    _GLFWwindow* window = NULL;
+
+    _glfwInputEventTimestamp((uint32_t) event->time);
+
+    window = findWindowByHandle(event->event);
+    if (!window)
+        return;
 
-    if (window->x11.overrideRedirect)
+    switch (type)
     {
-        int xpos, ypos;
-        GLFWvidmode mode;
+        case XI_ButtonPress:
+        case XI_ButtonRelease:
+        {
+            // Wheel buttons emulated from tracked scroll valuators are
+            // already reported through the motion events that carry them
+            if (event->flags & XIPointerEmulated &&
+                event->detail >= Button4 && event->detail <= Button7 &&
+                hasScrollValuator(event->deviceid, event->detail >= Button6))
+            {
+                return;
+            }
 
-        // Manually position the window over its monitor
-        _glfwPlatformGetMonitorPos(window->monitor, &xpos, &ypos);
-        _glfwPlatformGetVideoMode(window->monitor, &mode);
+            inputButton(window,
+                        event->detail,
+                        type == XI_ButtonPress ? GLFW_PRESS : GLFW_RELEASE,
+                        translateState(event->mods.effective));
+            return;
+        }
 
-        XMoveResizeWindow(_glfw.x11.display, window->x11.handle,
-                          xpos, ypos, mode.width, mode.height);
-    }
+        case XI_Motion:
+        {
+            inputScrollValuators(window, event);
 
-    _glfwInputMonitorWindow(window->monitor, window);
+            // Valuators 0 and 1 of master pointers are the position
+            if (event->valuators.mask_len &&
+                (XIMaskIsSet(event->valuators.mask, 0) ||
+                 XIMaskIsSet(event->valuators.mask, 1)))
+            {
+                inputCursorMotion(window, event->event_x, event->event_y);
+            }
+
+            return;
+        }
+    }
 }
 
-// Remove the window and restore the original video mode
+// Process the specified Present completion event
 //
-static void releaseMonitor(_GLFWwindow* window)
+static void processPresentEvent(const XPresentCompleteNotifyEvent* event)
 {
-    if (window->monitor->window != window)
+    int flags;
+    _GLFWwindow* window;
+
+    // Skipped frames were replaced by newer ones before being shown
+    if (event->kind != PresentCompleteKindPixmap ||
+        event->mode == PresentCompleteModeSkip)
+    {
         return;
+    }
 
-    _glfwInputMonitorWindow(window->monitor, NULL);
-    _glfwRestoreVideoModeX11(window->monitor);
+    window = findWindowByHandle(event->window);
+    if (!window)
+        return;
 
-    _glfw.x11.saver.count--;
+    // The UST is the time of the vblank in microseconds of CLOCK_MONOTONIC, and
+    // the MSC counts vblanks, so together they give the refresh interval
+    if (window->x11.lastPresentMsc && event->msc > window->x11.lastPresentMsc)
+    {
+        window->x11.presentRefresh =
+            (double) (event->ust - window->x11.lastPresentUst) /
+            (event->msc - window->x11.lastPresentMsc) / 1e6;
+    }
 
-    if (_glfw.x11.saver.count == 0)
+    window->x11.lastPresentUst = event->ust;
+    window->x11.lastPresentMsc = event->msc;
+
+    flags = GLFW_PRESENTATION_HW_CLOCK;
+    if (event->mode == PresentCompleteModeFlip)
     {
-        // Restore old screen saver settings
-        XSetScreenSaver(_glfw.x11.display,
-                        _glfw.x11.saver.timeout,
-                        _glfw.x11.saver.interval,
-                        _glfw.x11.saver.blanking,
-                        _glfw.x11.saver.exposure);
+        flags |= GLFW_PRESENTATION_VSYNC |
+                 GLFW_PRESENTATION_HW_COMPLETION |
+                 GLFW_PRESENTATION_ZERO_COPY;
     }
+
+    _glfwInputFramePresented(window,
+                             _glfwTimeFromClockPOSIX(CLOCK_MONOTONIC, event->ust / 1e6),
+                             window->x11.presentRefresh,
+                             flags);
 }
 
-static void onConfigChange()
+// Returns the server timestamp of the specified X event, or zero if it has
+// none
+//
+static Time getEventTime(const XEvent* event)
 {
-    float xscale, yscale;
-    _glfwGetSystemContentScaleX11(&xscale, &yscale, GLFW_TRUE);
-
-    if (xscale != _glfw.x11.contentScaleX || yscale != _glfw.x11.contentScaleY)
+    switch (event->type)
     {
-        _GLFWwindow* window = _glfw.windowListHead;
-        _glfw.x11.contentScaleX = xscale;
-        _glfw.x11.contentScaleY = yscale;
-        while (window)
-        {
-            _glfwInputWindowContentScale(window, xscale, yscale);
-            window = window->next;
-        }
+        case KeyPress:
+        case KeyRelease:
+            return event->xkey.time;
+        case ButtonPress:
+        case ButtonRelease:
+            return event->xbutton.time;
+        case MotionNotify:
+            return event->xmotion.time;
+        case EnterNotify:
+        case LeaveNotify:
+            return event->xcrossing.time;
+        case PropertyNotify:
+            return event->xproperty.time;
     }
+
+    return 0;
 }
 
 // Process the specified X event
@@ -1072,6 +2325,8 @@ static void processEvent(XEvent *event)
     _GLFWwindow* window = NULL;
     Bool filtered = False;
 
+    _glfwInputEventTimestamp((uint32_t) getEventTime(event));
+
     if (_glfw.x11.randr.available)
     {
         if (event->type == _glfw.x11.randr.eventBase + RRNotify)
@@ -1092,16 +2347,24 @@ static void processEvent(XEvent *event)
 
     if (event->type == GenericEvent)
     {
-        if (_glfw.x11.xi.available)
+        if (_glfw.x11.xi.available &&
+            event->xcookie.extension == _glfw.x11.xi.majorOpcode &&
+            getEventData(&event->xcookie))
         {
             _GLFWwindow* window = _glfw.x11.disabledCursorWindow;
 
-            if (window &&
-                event->xcookie.extension == _glfw.x11.xi.majorOpcode &&
-                XGetEventData(_glfw.x11.display, &event->xcookie) &&
-                event->xcookie.evtype == XI_RawMotion)
+            if (event->xcookie.evtype == XI_ButtonPress ||
+                event->xcookie.evtype == XI_ButtonRelease ||
+                event->xcookie.evtype == XI_Motion)
+            {
+                processDeviceEvent(event->xcookie.evtype, event->xcookie.data);
+            }
+            else if (event->xcookie.evtype == XI_DeviceChanged)
+                _glfwUpdateScrollValuatorsX11();
+            else if (window && event->xcookie.evtype == XI_RawMotion)
             {
                 XIRawEvent* re = event->xcookie.data;
+                _glfwInputEventTimestamp((uint32_t) re->time);
                 if (re->valuators.mask_len)
                 {
                     const double* values = re->raw_values;
@@ -1121,7 +2384,16 @@ static void processEvent(XEvent *event)
                 }
             }
 
-            XFreeEventData(_glfw.x11.display, &event->xcookie);
+            freeEventData(&event->xcookie);
+        }
+        else if (_glfw.x11.xpresent.available &&
+                 event->xcookie.extension == _glfw.x11.xpresent.majorOpcode &&
+                 getEventData(&event->xcookie))
+        {
+            if (event->xcookie.evtype == PresentCompleteNotify)
+                processPresentEvent(event->xcookie.data);
+
+            freeEventData(&event->xcookie);
         }
 
         return;
@@ -1137,6 +2409,19 @@ static void processEvent(XEvent *event)
         handleSelectionRequest(event);
         return;
     }
+    else if (event->type == PropertyNotify && handleSelectionTransferEvent(event))
+        return;
+    else if (event->type == SelectionNotify && isClipboardRequestNotify(event))
+    {
+        handleClipboardRequestNotify(event);
+        return;
+    }
+    else if (event->type == PropertyNotify &&
+             event->xproperty.window == _glfw.x11.helperWindowHandle)
+    {
+        handleClipboardRequestProperty(event);
+        return;
+    }
     else if (event->type == _glfw.x11.xkb.eventBase)
     {
         XkbEvent *kb_event = (XkbEvent*)event;
@@ -1162,10 +2447,8 @@ static void processEvent(XEvent *event)
         return;
     }
 
-    if (XFindContext(_glfw.x11.display,
-                     event->xany.window,
-                     _glfw.x11.context,
-                     (XPointer*) &window) != 0)
+    window = findWindowByHandle(event->xany.window);
+    if (!window)
     {
         // This is an event for a window that has already been destroyed
         return;
@@ -1187,28 +2470,25 @@ static void processEvent(XEvent *event)
                 //       pairs with similar or identical time stamps
                 //       The key repeat logic in _glfwInputKey expects only key
                 //       presses to repeat, so detect and discard release events
-                if (XEventsQueued(_glfw.x11.display, QueuedAfterReading))
-                {
-                    XEvent next;
-                    XPeekEvent(_glfw.x11.display, &next);
+                XEvent next;
 
-                    if (next.type == KeyPress &&
-                        next.xkey.window == event->xkey.window &&
-                        next.xkey.keycode == event->xkey.keycode)
+                if (peekEvent(&next) &&
+                    next.type == KeyPress &&
+                    next.xkey.window == event->xkey.window &&
+                    next.xkey.keycode == event->xkey.keycode)
+                {
+                    // HACK: The time of repeat events sometimes doesn't
+                    //       match that of the press event, so add an
+                    //       epsilon
+                    //       Toshiyuki Takahashi can press a button
+                    //       16 times per second so it's fairly safe to
+                    //       assume that no human is pressing the key 50
+                    //       times per second (value is ms)
+                    if ((next.xkey.time - event->xkey.time) < 20)
                     {
-                        // HACK: The time of repeat events sometimes doesn't
-                        //       match that of the press event, so add an
-                        //       epsilon
-                        //       Toshiyuki Takahashi can press a button
-                        //       16 times per second so it's fairly safe to
-                        //       assume that no human is pressing the key 50
-                        //       times per second (value is ms)
-                        if ((next.xkey.time - event->xkey.time) < 20)
-                        {
-                            // This is very likely a server-generated key repeat
-                            // event, so ignore it
-                            return;
-                        }
+                        // This is very likely a server-generated key repeat
+                        // event, so ignore it
+                        return;
                     }
                 }
             }
@@ -1219,73 +2499,20 @@ static void processEvent(XEvent *event)
 
         case ButtonPress:
         {
-            const int mods = translateState(event->xbutton.state);
-
-            if (event->xbutton.button == Button1)
-                _glfwInputMouseClick(window, GLFW_MOUSE_BUTTON_LEFT, GLFW_PRESS, mods);
-            else if (event->xbutton.button == Button2)
-                _glfwInputMouseClick(window, GLFW_MOUSE_BUTTON_MIDDLE, GLFW_PRESS, mods);
-            else if (event->xbutton.button == Button3)
-                _glfwInputMouseClick(window, GLFW_MOUSE_BUTTON_RIGHT, GLFW_PRESS, mods);
-
-            // Modern X provides scroll events as mouse button presses
-            else if (event->xbutton.button == Button4)
-                _glfwInputScroll(window, 0.0, 1.0, 0);
-            else if (event->xbutton.button == Button5)
-                _glfwInputScroll(window, 0.0, -1.0, 0);
-            else if (event->xbutton.button == Button6)
-                _glfwInputScroll(window, 1.0, 0.0, 0);
-            else if (event->xbutton.button == Button7)
-                _glfwInputScroll(window, -1.0, 0.0, 0);
-
-            else
-            {
-                // Additional buttons after 7 are treated as regular buttons
-                // We subtract 4 to fill the gap left by scroll input above
-                _glfwInputMouseClick(window,
-                                     event->xbutton.button - Button1 - 4,
-                                     GLFW_PRESS,
-                                     mods);
-            }
-
+            // Only received while the pointer is grabbed or without XI2
+            inputButton(window,
+                        event->xbutton.button,
+                        GLFW_PRESS,
+                        translateState(event->xbutton.state));
             return;
         }
 
         case ButtonRelease:
         {
-            const int mods = translateState(event->xbutton.state);
-
-            if (event->xbutton.button == Button1)
-            {
-                _glfwInputMouseClick(window,
-                                     GLFW_MOUSE_BUTTON_LEFT,
-                                     GLFW_RELEASE,
-                                     mods);
-            }
-            else if (event->xbutton.button == Button2)
-            {
-                _glfwInputMouseClick(window,
-                                     GLFW_MOUSE_BUTTON_MIDDLE,
-                                     GLFW_RELEASE,
-                                     mods);
-            }
-            else if (event->xbutton.button == Button3)
-            {
-                _glfwInputMouseClick(window,
-                                     GLFW_MOUSE_BUTTON_RIGHT,
-                                     GLFW_RELEASE,
-                                     mods);
-            }
-            else if (event->xbutton.button > Button7)
-            {
-                // Additional buttons after 7 are treated as regular buttons
-                // We subtract 4 to fill the gap left by scroll input above
-                _glfwInputMouseClick(window,
-                                     event->xbutton.button - Button1 - 4,
-                                     GLFW_RELEASE,
-                                     mods);
-            }
-
+            inputButton(window,
+                        event->xbutton.button,
+                        GLFW_RELEASE,
+                        translateState(event->xbutton.state));
             return;
         }
 
@@ -1296,6 +2523,10 @@ static void processEvent(XEvent *event)
             if (window->cursorMode == GLFW_CURSOR_HIDDEN)
                 updateCursorImage(window);
 
+            // The scroll valuators may have been changed by other clients
+            // while the cursor was outside
+            _glfwUpdateScrollValuatorsX11();
+
             _glfwInputCursorEnter(window, GLFW_TRUE);
             return;
         }
@@ -1308,68 +2539,18 @@ static void processEvent(XEvent *event)
 
         case MotionNotify:
         {
-            const int x = event->xmotion.x;
-            const int y = event->xmotion.y;
-
-            if (x != window->x11.warpCursorPosX ||
-                y != window->x11.warpCursorPosY)
-            {
-                // The cursor was moved by something other than GLFW
-
-                if (window->cursorMode == GLFW_CURSOR_DISABLED)
-                {
-                    if (_glfw.x11.disabledCursorWindow != window)
-                        return;
-                    if (_glfw.x11.xi.available)
-                        return;
-
-                    const int dx = x - window->x11.lastCursorPosX;
-                    const int dy = y - window->x11.lastCursorPosY;
-
-                    _glfwInputCursorPos(window,
-                                        window->virtualCursorPosX + dx,
-                                        window->virtualCursorPosY + dy);
-                }
-                else
-                    _glfwInputCursorPos(window, x, y);
-            }
-
-            window->x11.lastCursorPosX = x;
-            window->x11.lastCursorPosY = y;
+            inputCursorMotion(window, event->xmotion.x, event->xmotion.y);
             return;
         }
 
         case ConfigureNotify:
         {
-            if (event->xconfigure.width != window->x11.width ||
-                event->xconfigure.height != window->x11.height)
-            {
-                _glfwInputFramebufferSize(window,
-                                          event->xconfigure.width,
-                                          event->xconfigure.height);
-
-                _glfwInputWindowSize(window,
-                                     event->xconfigure.width,
-                                     event->xconfigure.height);
-
-                window->x11.width = event->xconfigure.width;
-                window->x11.height = event->xconfigure.height;
-            }
-
-            if (event->xconfigure.x != window->x11.xpos ||
-                event->xconfigure.y != window->x11.ypos)
-            {
-                if (window->x11.overrideRedirect || event->xany.send_event)
-                {
-                    _glfwInputWindowPos(window,
-                                        event->xconfigure.x,
-                                        event->xconfigure.y);
-
-                    window->x11.xpos = event->xconfigure.x;
-                    window->x11.ypos = event->xconfigure.y;
-                }
-            }
-
+            inputConfigure(window,
+                           event->xconfigure.x,
+                           event->xconfigure.y,
+                           event->xconfigure.width,
+                           event->xconfigure.height,
+                           event->xany.send_event);
             return;
         }
 
@@ -1728,7 +2909,7 @@ void _glfwPushSelectionToManagerX11(void)
     {
         XEvent event;
 
-        while (XCheckIfEvent(_glfw.x11.display, &event, isSelectionEvent, NULL))
+        while (checkIfEvent(&event, isSelectionEvent, NULL))
         {
             switch (event.type)
             {
@@ -1740,6 +2921,10 @@ void _glfwPushSelectionToManagerX11(void)
                     handleSelectionClear(&event);
                     break;
 
+                case PropertyNotify:
+                    handleSelectionTransferEvent(&event);
+                    break;
+
                 case SelectionNotify:
                 {
                     if (event.xselection.target == _glfw.x11.SAVE_TARGETS)
@@ -1761,6 +2946,24 @@ void _glfwPushSelectionToManagerX11(void)
     }
 }
 
+// Abandons the incremental transfers of the selection, or of all selections
+// if it is None, before its string is freed
+//
+void _glfwCancelSelectionTransfersX11(Atom selection)
+{
+    _GLFWselectiontransferX11* transfer = _glfw.x11.selectionTransfers;
+
+    while (transfer)
+    {
+        _GLFWselectiontransferX11* next = transfer->next;
+
+        if (selection == None || transfer->selection == selection)
+            freeSelectionTransfer(transfer);
+
+        transfer = next;
+    }
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 //////                       GLFW platform API                      //////
@@ -1850,7 +3053,9 @@ void _glfwPlatformDestroyWindow(_GLFWwindow* window)
 
     if (window->x11.handle)
     {
-        XDeleteContext(_glfw.x11.display, window->x11.handle, _glfw.x11.context);
+        _glfwWindowMapRemove(&_glfw.x11.windowsByHandle, window->x11.handle);
+        if (_glfw.x11.lastEventWindow == window)
+            _glfw.x11.lastEventWindow = NULL;
         XUnmapWindow(_glfw.x11.display, window->x11.handle);
         XDestroyWindow(_glfw.x11.display, window->x11.handle);
         window->x11.handle = (Window) 0;
@@ -1901,7 +3106,7 @@ void _glfwPlatformSetWindowIcon(_GLFWwindow* window,
 {
     if (count)
     {
-        int i, j, longCount = 0;
+        int i, longCount = 0;
 
         for (i = 0;  i < count;  i++)
             longCount += 2 + images[i].width * images[i].height;
@@ -1911,16 +3116,13 @@ void _glfwPlatformSetWindowIcon(_GLFWwindow* window,
 
         for (i = 0;  i < count;  i++)
         {
+            const size_t pixels = (size_t) images[i].width * images[i].height;
+
             *target++ = images[i].width;
             *target++ = images[i].height;
 
-            for (j = 0;  j < images[i].width * images[i].height;  j++)
-            {
-                *target++ = (images[i].pixels[j * 4 + 0] << 16) |
-                            (images[i].pixels[j * 4 + 1] <<  8) |
-                            (images[i].pixels[j * 4 + 2] <<  0) |
-                            (images[i].pixels[j * 4 + 3] << 24);
-            }
+            convertToARGB32Long(target, images[i].pixels, pixels);
+            target += pixels;
         }
 
         XChangeProperty(_glfw.x11.display, window->x11.handle,
@@ -2058,10 +3260,9 @@ void _glfwPlatformGetWindowFrameSize(_GLFWwindow* window,
         //       They have been fixed but broken versions are still in the wild
         //       If you are affected by this and your window manager is NOT
         //       listed above, PLEASE report it to their and our issue trackers
-        while (!XCheckIfEvent(_glfw.x11.display,
-                              &event,
-                              isFrameExtentsEvent,
-                              (XPointer) window))
+        while (!checkIfEvent(&event,
+                             isFrameExtentsEvent,
+                             (XPointer) window))
         {
             if (!waitForX11Event(0.5))
             {
@@ -2464,6 +3665,139 @@ void _glfwPlatformSetWindowOpacity(_GLFWwindow* window, float opacity)
                     PropModeReplace, (unsigned char*) &value, 1);
 }
 
+void _glfwPlatformRequestWindowFrame(_GLFWwindow* window)
+{
+    window->frameRequested = GLFW_TRUE;
+}
+
+void _glfwPlatformPrepareFramePresentation(_GLFWwindow* window)
+{
+    const GLFWbool enabled = window->callbacks.framePresented != NULL;
+
+    if (!_glfw.x11.xpresent.available)
+        return;
+
+    if (enabled && !window->x11.presentEventId)
+    {
+        // Completion is reported to every client selecting it on the window,
+        // including for the presentations made by the OpenGL driver
+        window->x11.presentEventId =
+            XPresentSelectInput(_glfw.x11.display, window->x11.handle,
+                                PresentCompleteNotifyMask);
+        window->x11.lastPresentMsc = 0;
+    }
+    else if (!enabled && window->x11.presentEventId)
+    {
+        XPresentFreeInput(_glfw.x11.display, window->x11.handle,
+                          window->x11.presentEventId);
+        window->x11.presentEventId = 0;
+    }
+}
+
+#if defined(_GLFW_X11_XCB_EVENTS)
+
+// Process an event read from XCB, where the most frequent events are handled
+// without converting them to Xlib events
+//
+static void processXCBEvent(xcb_generic_event_t* source)
+{
+    const int type = source->response_type & 0x7f;
+    _GLFWwindow* window;
+    XEvent event;
+
+    switch (type)
+    {
+        case 0:
+        {
+            inputXCBError((xcb_generic_error_t*) source);
+            return;
+        }
+
+        case XCB_KEY_PRESS:
+        case XCB_KEY_RELEASE:
+        {
+            const xcb_key_press_event_t* key = (xcb_key_press_event_t*) source;
+
+            // Releases that may be server key repeats are told apart by the
+            // event following them, see processEvent
+            if (type == XCB_KEY_RELEASE && !_glfw.x11.xkb.detectable)
+                break;
+
+            _glfwInputEventTimestamp(key->time);
+            window = findWindowByHandle(key->event);
+            if (window)
+            {
+                glfw_xkb_handle_key_event(window, &_glfw.x11.xkb, key->detail,
+                                          type == XCB_KEY_PRESS ? GLFW_PRESS : GLFW_RELEASE);
+            }
+            return;
+        }
+
+        case XCB_BUTTON_PRESS:
+        case XCB_BUTTON_RELEASE:
+        {
+            const xcb_button_press_event_t* button = (xcb_button_press_event_t*) source;
+
+            _glfwInputEventTimestamp(button->time);
+            window = findWindowByHandle(button->event);
+            if (window)
+            {
+                inputButton(window,
+                            button->detail,
+                            type == XCB_BUTTON_PRESS ? GLFW_PRESS : GLFW_RELEASE,
+                            translateState(button->state));
+            }
+            return;
+        }
+
+        case XCB_MOTION_NOTIFY:
+        {
+            const xcb_motion_notify_event_t* motion = (xcb_motion_notify_event_t*) source;
+
+            _glfwInputEventTimestamp(motion->time);
+            window = findWindowByHandle(motion->event);
+            if (window)
+                inputCursorMotion(window, motion->event_x, motion->event_y);
+            return;
+        }
+
+        case XCB_CONFIGURE_NOTIFY:
+        {
+            const xcb_configure_notify_event_t* configure =
+                (xcb_configure_notify_event_t*) source;
+
+            _glfwInputEventTimestamp(0);
+            window = findWindowByHandle(configure->event);
+            if (window)
+            {
+                inputConfigure(window,
+                               configure->x,
+                               configure->y,
+                               configure->width,
+                               configure->height,
+                               (source->response_type & 0x80) != 0);
+            }
+            return;
+        }
+
+        case XCB_EXPOSE:
+        {
+            const xcb_expose_event_t* expose = (xcb_expose_event_t*) source;
+
+            _glfwInputEventTimestamp(0);
+            window = findWindowByHandle(expose->window);
+            if (window)
+                _glfwInputWindowDamage(window);
+            return;
+        }
+    }
+
+    if (convertXCBEvent(source, &event))
+        processEvent(&event);
+}
+
+#endif // _GLFW_X11_XCB_EVENTS
+
 GLFWbool
 _glfwDispatchX11Events(void) {
     _GLFWwindow* window;
@@ -2472,6 +3806,41 @@ _glfwDispatchX11Events(void) {
 #if defined(__linux__)
     _glfwDetectJoystickConnectionLinux();
 #endif
+#if defined(_GLFW_X11_XCB_EVENTS)
+    GLFWbool read = GLFW_FALSE;
+
+    XFlush(_glfw.x11.display);
+
+    for (;;)
+    {
+        xcb_generic_event_t* source;
+
+        // Events read while waiting for another event come first
+        if (_glfw.x11.xcb.count)
+        {
+            XEvent event;
+            dequeueXCBEvent(0, &event);
+            processEvent(&event);
+            dispatched = GLFW_TRUE;
+            continue;
+        }
+
+        // The socket is read once, after which only the events already read
+        // are dispatched, like with Xlib
+        if (read)
+            source = xcb_poll_for_queued_event(_glfw.x11.xcb.connection);
+        else
+            source = xcb_poll_for_event(_glfw.x11.xcb.connection);
+
+        read = GLFW_TRUE;
+        if (!source)
+            break;
+
+        processXCBEvent(source);
+        free(source);
+        dispatched = GLFW_TRUE;
+    }
+#else
     XPending(_glfw.x11.display);
 
     while (XQLength(_glfw.x11.display))
@@ -2481,6 +3850,7 @@ _glfwDispatchX11Events(void) {
         processEvent(&event);
         dispatched = GLFW_TRUE;
     }
+#endif
 
     window = _glfw.x11.disabledCursorWindow;
     if (window)
@@ -2521,17 +3891,7 @@ void _glfwPlatformWaitEventsTimeout(double timeout)
 
 void _glfwPlatformPostEmptyEvent(void)
 {
-    XEvent event;
-
-    memset(&event, 0, sizeof(event));
-    event.type = ClientMessage;
-    event.xclient.window = _glfw.x11.helperWindowHandle;
-    event.xclient.format = 32; // Data is 32-bit longs
-    event.xclient.message_type = _glfw.x11.NULL_;
-
-    XSendEvent(_glfw.x11.display, _glfw.x11.helperWindowHandle, False, 0, &event);
-    XFlush(_glfw.x11.display);
-    while (write(_glfw.x11.eventLoopData.wakeupFds[1], "w", 1) < 0 && errno == EINTR);
+    wakeupEventLoop(&_glfw.x11.eventLoopData);
 }
 
 void _glfwPlatformGetCursorPos(_GLFWwindow* window, double* xpos, double* ypos)
@@ -2646,6 +4006,7 @@ void _glfwPlatformSetCursor(_GLFWwindow* window, _GLFWcursor* cursor)
 
 void _glfwPlatformSetClipboardString(const char* string)
 {
+    _glfwCancelSelectionTransfersX11(_glfw.x11.CLIPBOARD);
     free(_glfw.x11.clipboardString);
     _glfw.x11.clipboardString = _glfw_strdup(string);
 
@@ -2662,11 +4023,59 @@ void _glfwPlatformSetClipboardString(const char* string)
     }
 }
 
+void _glfwPlatformSetClipboardProvider(void)
+{
+    // The data is converted on request, see writeTargetToProperty
+    _glfwCancelSelectionTransfersX11(_glfw.x11.CLIPBOARD);
+    free(_glfw.x11.clipboardString);
+    _glfw.x11.clipboardString = NULL;
+
+    XSetSelectionOwner(_glfw.x11.display,
+                       _glfw.x11.CLIPBOARD,
+                       _glfw.x11.helperWindowHandle,
+                       CurrentTime);
+
+    if (XGetSelectionOwner(_glfw.x11.display, _glfw.x11.CLIPBOARD) !=
+        _glfw.x11.helperWindowHandle)
+    {
+        _glfwInputError(GLFW_PLATFORM_ERROR,
+                        "X11: Failed to become owner of clipboard selection");
+    }
+}
+
 const char* _glfwPlatformGetClipboardString(void)
 {
     return getSelectionString(_glfw.x11.CLIPBOARD);
 }
 
+GLFWbool _glfwPlatformGetClipboardData(GLFWclipboarddatafun callback, void* user_data)
+{
+    if (XGetSelectionOwner(_glfw.x11.display, _glfw.x11.CLIPBOARD) ==
+        _glfw.x11.helperWindowHandle)
+    {
+        size_t size;
+        const char* data = getOwnClipboardData("text/plain;charset=utf-8", &size);
+
+        if (!data)
+        {
+            _glfwInputError(GLFW_FORMAT_UNAVAILABLE,
+                            "X11: Failed to convert selection to string");
+            return GLFW_FALSE;
+        }
+
+        callback(data, size, user_data);
+        return GLFW_TRUE;
+    }
+
+    return receiveSelection(_glfw.x11.CLIPBOARD, callback, user_data);
+}
+
+GLFWbool _glfwPlatformRequestClipboard(_GLFWclipboardrequest* request)
+{
+    startClipboardRequests();
+    return GLFW_TRUE;
+}
+
 void _glfwPlatformGetRequiredInstanceExtensions(char** extensions)
 {
     if (!_glfw.vk.KHR_surface)
@@ -2842,6 +4251,7 @@ GLFWAPI void glfwSetX11SelectionString(const char* string)
 {
     _GLFW_REQUIRE_INIT();
 
+    _glfwCancelSelectionTransfersX11(_glfw.x11.PRIMARY);
     free(_glfw.x11.primarySelectionString);
     _glfw.x11.primarySelectionString = _glfw_strdup(string);
 
@@ -2864,6 +4274,6 @@ GLFWAPI const char* glfwGetX11SelectionString(void)
     return getSelectionString(_glfw.x11.PRIMARY);
 }
 
-GLFWAPI int glfwGetXKBScancode(const char* keyName, GLFWbool caseSensitive) {
+GLFWAPI int glfwGetXKBScancode(const char* keyName, int caseSensitive) {
     return glfw_xkb_keysym_from_name(keyName, caseSensitive);
 }
@@ -0,0 +1,157 @@
+//========================================================================
+// Wayland cursor cache test
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+//
+// This test checks that setting the cursor the window already shows sends
+// nothing to the compositor, and that a new cursor is always sent, even when
+// it reuses the shared memory of a destroyed one
+//
+// The pointer has to be moved into the window for the test to run
+//
+//========================================================================
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#define GLFW_EXPOSE_NATIVE_WAYLAND
+#include <GLFW/glfw3native.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int entered = GLFW_FALSE;
+
+static void error_callback(int error, const char* description)
+{
+    fprintf(stderr, "Error: %s\n", description);
+}
+
+static void cursor_enter_callback(GLFWwindow* window, int entered_)
+{
+    entered = entered_;
+}
+
+static GLFWcursor* create_cursor(unsigned char value)
+{
+    unsigned char pixels[16 * 16 * 4];
+    GLFWimage image = { 16, 16, pixels };
+
+    memset(pixels, value, sizeof(pixels));
+    return glfwCreateCursor(&image, 0, 0, 1);
+}
+
+static void redraw(GLFWwindow* window)
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    glfwSwapBuffers(window);
+}
+
+// Returns the number of bytes sent by setting the cursor
+//
+static int set_cursor(struct wl_display* display,
+                      GLFWwindow* window,
+                      GLFWcursor* cursor)
+{
+    wl_display_flush(display);
+    glfwSetCursor(window, cursor);
+    return wl_display_flush(display);
+}
+
+static int check(const char* name, int sent, int expected)
+{
+    const int ok = expected ? sent > 0 : sent == 0;
+    printf("%-24s %4i bytes sent %s\n", name, sent, ok ? "OK" : "FAILED");
+    return ok;
+}
+
+int main(void)
+{
+    int i, ok = GLFW_TRUE;
+    double start;
+    struct wl_display* display;
+    GLFWwindow* window;
+    GLFWcursor* cursor;
+
+    glfwSetErrorCallback(error_callback);
+
+    if (!glfwInit())
+        exit(EXIT_FAILURE);
+
+    display = glfwGetWaylandDisplay();
+    if (!display)
+    {
+        glfwTerminate();
+        exit(EXIT_FAILURE);
+    }
+
+    window = glfwCreateWindow(400, 400, "Cursor Cache", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        exit(EXIT_FAILURE);
+    }
+
+    glfwMakeContextCurrent(window);
+    gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
+    glfwSetCursorEnterCallback(window, cursor_enter_callback);
+
+    printf("Move the pointer into the window\n");
+
+    start = glfwGetTime();
+    while (!entered && glfwGetTime() - start < 30.0)
+    {
+        redraw(window);
+        glfwWaitEventsTimeout(0.1);
+    }
+
+    if (!entered)
+    {
+        fprintf(stderr, "Timed out waiting for the pointer\n");
+        glfwTerminate();
+        exit(EXIT_FAILURE);
+    }
+
+    ok &= check("standard cursor again", set_cursor(display, window, NULL), 0);
+
+    cursor = create_cursor(0xff);
+    ok &= check("custom cursor", set_cursor(display, window, cursor), 1);
+    ok &= check("custom cursor again", set_cursor(display, window, cursor), 0);
+    glfwDestroyCursor(cursor);
+
+    // Let the compositor release the buffer of the destroyed cursor, so that
+    // it can be handed out again
+    for (i = 0;  i < 5;  i++)
+    {
+        redraw(window);
+        glfwWaitEventsTimeout(0.05);
+    }
+
+    cursor = create_cursor(0x80);
+    ok &= check("recreated cursor", set_cursor(display, window, cursor), 1);
+    ok &= check("recreated cursor again", set_cursor(display, window, cursor), 0);
+    glfwDestroyCursor(cursor);
+
+    glfwTerminate();
+    exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,302 @@
+//========================================================================
+// Headless input and window path benchmark
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+//
+// This benchmark injects synthetic key, cursor motion, scroll and resize
+// streams into the shared input code through the null platform, and measures
+// the cost of callback dispatch, focused window lookup, key state tracking
+// and timer dispatch without needing a display server or a GPU
+//
+//========================================================================
+
+#include "internal.h"
+#include "backend_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "getopt.h"
+
+static unsigned long long callbacks = 0;
+
+static void error_callback(int error, const char* description)
+{
+    fprintf(stderr, "Error: %s\n", description);
+}
+
+static void keyboard_callback(GLFWwindow* window, int key, int scancode, int action, int mods, const char* text, int state)
+{
+    callbacks++;
+}
+
+static void cursor_pos_callback(GLFWwindow* window, double x, double y)
+{
+    callbacks++;
+}
+
+static void scroll_callback(GLFWwindow* window, double x, double y, int flags)
+{
+    callbacks++;
+}
+
+static void window_size_callback(GLFWwindow* window, int width, int height)
+{
+    callbacks++;
+}
+
+static void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    callbacks++;
+}
+
+static void timer_callback(id_type timer_id, void* data)
+{
+    callbacks++;
+}
+
+static double now(void)
+{
+    return (double) glfwGetTimerValue() / (double) glfwGetTimerFrequency();
+}
+
+static void report(const char* name, unsigned long long events, double elapsed)
+{
+    printf("%-32s %12llu events %10.1f ns/event %10.2f M events/s\n",
+           name, events, elapsed * 1e9 / events, events / elapsed / 1e6);
+}
+
+static GLFWwindow* create_window(void)
+{
+    GLFWwindow* window = glfwCreateWindow(640, 480, "Benchmark", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        exit(EXIT_FAILURE);
+    }
+
+    return window;
+}
+
+static void usage(void)
+{
+    printf("Usage: glfw_bench [-n EVENTS] [-t TIMERS]\n");
+    printf("       glfw_bench -h\n");
+}
+
+int main(int argc, char** argv)
+{
+    int ch, i, j, events = 1000000, timer_count = 500, window_count = 1;
+    const int lookup_window_counts[] = { 1, 100, 1000 };
+    unsigned long long fired, batched = 0;
+    double start;
+    uintptr_t checksum = 0;
+    GLFWwindow* handle;
+    _GLFWwindow* window;
+    EventLoopData eld = {0};
+
+    while ((ch = getopt(argc, argv, "hn:t:")) != -1)
+    {
+        switch (ch)
+        {
+            case 'h':
+                usage();
+                exit(EXIT_SUCCESS);
+            case 'n':
+                events = atoi(optarg);
+                break;
+            case 't':
+                timer_count = atoi(optarg);
+                break;
+            default:
+                usage();
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (events <= 0 || timer_count <= 0)
+    {
+        usage();
+        exit(EXIT_FAILURE);
+    }
+
+    glfwSetErrorCallback(error_callback);
+
+    if (!glfwInit())
+        exit(EXIT_FAILURE);
+
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    handle = create_window();
+    window = (_GLFWwindow*) handle;
+
+    glfwSetKeyboardCallback(handle, keyboard_callback);
+    glfwSetCursorPosCallback(handle, cursor_pos_callback);
+    glfwSetScrollCallback(handle, scroll_callback);
+    glfwSetWindowSizeCallback(handle, window_size_callback);
+    glfwSetFramebufferSizeCallback(handle, framebuffer_size_callback);
+
+    start = now();
+    for (i = 0;  i < events / 2;  i++)
+    {
+        const int key = GLFW_KEY_A + i % 26;
+        _glfwInputKeyboard(window, key, key, GLFW_PRESS, 0, "a", 0);
+        _glfwInputKeyboard(window, key, key, GLFW_RELEASE, 0, "", 0);
+    }
+    report("key", (events / 2) * 2ull, now() - start);
+
+    start = now();
+    for (i = 0;  i < events;  i++)
+        _glfwInputCursorPos(window, i & 1023, 1 + (i >> 10));
+    report("cursor motion", events, now() - start);
+
+    // Coalesced motion is reported once per event processing call, which is
+    // simulated here with 64 motion events per call
+    glfwSetInputMode(handle, GLFW_COALESCE_MOTION, GLFW_TRUE);
+    start = now();
+    for (i = 0;  i < events;  i++)
+    {
+        if (i % 64 == 0)
+            _glfwInputBeginEvents();
+
+        _glfwInputCursorPos(window, i & 1023, 2000 + (i >> 10));
+
+        if (i % 64 == 63 || i == events - 1)
+            _glfwInputEndEvents();
+    }
+    report("coalesced motion", events, now() - start);
+    glfwSetInputMode(handle, GLFW_COALESCE_MOTION, GLFW_FALSE);
+
+    // Batched events are left pending 16384 at a time and drained 256 at a
+    // time, alternating between sets of motion events only and sets with a
+    // key event in every 16 to exercise the text storage
+    glfwSetInputMode(handle, GLFW_EVENT_BATCHING, GLFW_TRUE);
+    start = now();
+    for (i = 0;  i < events;  i++)
+    {
+        if ((i / 16384) % 2 && i % 16 == 0)
+            _glfwInputKeyboard(window, GLFW_KEY_A, GLFW_KEY_A, GLFW_PRESS, 0, "a", 0);
+        else
+            _glfwInputCursorPos(window, i & 1023, 3000 + (i >> 10));
+
+        if (i % 16384 == 16383 || i == events - 1)
+        {
+            GLFWevent batch[256];
+            int count;
+
+            while ((count = glfwGetEventBatch(handle, batch, 256)))
+            {
+                for (j = 0;  j < count;  j++)
+                {
+                    if (batch[j].type == GLFW_EVENT_KEY && strcmp(batch[j].text, "a") != 0)
+                    {
+                        fprintf(stderr, "Batched key event has the wrong text\n");
+                        exit(EXIT_FAILURE);
+                    }
+                }
+
+                batched += count;
+            }
+        }
+    }
+    report("batched events", events, now() - start);
+    glfwSetInputMode(handle, GLFW_EVENT_BATCHING, GLFW_FALSE);
+
+    if (batched != (unsigned long long) events)
+    {
+        fprintf(stderr, "%llu of %i batched events returned\n", batched, events);
+        exit(EXIT_FAILURE);
+    }
+
+    start = now();
+    for (i = 0;  i < events;  i++)
+        _glfwInputScroll(window, 0.0, i & 1 ? 1.0 : -1.0, 0);
+    report("scroll", events, now() - start);
+
+    start = now();
+    for (i = 0;  i < events / 2;  i++)
+    {
+        _glfwInputWindowSize(window, 640 + (i & 63), 480);
+        _glfwInputFramebufferSize(window, 640 + (i & 63), 480);
+    }
+    report("resize", (events / 2) * 2ull, now() - start);
+
+    // New windows are added to the head of the window list, so the first
+    // window is the most expensive one to find by walking the list
+    _glfwInputWindowFocus(window, GLFW_TRUE);
+
+    for (j = 0;  j < (int) (sizeof(lookup_window_counts) / sizeof(lookup_window_counts[0]));  j++)
+    {
+        char name[64];
+
+        while (window_count < lookup_window_counts[j])
+        {
+            create_window();
+            window_count++;
+        }
+
+        start = now();
+        for (i = 0;  i < events;  i++)
+            checksum += (uintptr_t) _glfwFocusedWindow();
+        snprintf(name, sizeof(name), "focused window (%i windows)", window_count);
+        report(name, events, now() - start);
+
+        start = now();
+        for (i = 0;  i < events;  i++)
+            checksum += (uintptr_t) _glfwWindowForId(window->id);
+        snprintf(name, sizeof(name), "window id lookup (%i windows)", window_count);
+        report(name, events, now() - start);
+    }
+
+    _glfwInputKeyboard(window, GLFW_KEY_SPACE, GLFW_KEY_SPACE, GLFW_PRESS, 0, " ", 0);
+
+    start = now();
+    for (i = 0;  i < events;  i++)
+        checksum += glfwGetKey(handle, GLFW_KEY_A + i % 26) + glfwGetKey(handle, GLFW_KEY_SPACE);
+    report("key state query", events * 2ull, now() - start);
+
+    // Timers with a zero interval expire on every dispatch
+    for (i = 0;  i < timer_count;  i++)
+    {
+        if (!addTimer(&eld, "benchmark", 0.0, 1, timer_callback, NULL))
+        {
+            glfwTerminate();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    fired = callbacks;
+    start = now();
+    for (i = 0;  i < events / timer_count + 1;  i++)
+        dispatchTimers(&eld);
+    report("timer dispatch", callbacks - fired, now() - start);
+
+    finalizePollData(&eld);
+
+    printf("%llu callbacks (checksum %lu)\n", callbacks, (unsigned long) checksum);
+
+    glfwTerminate();
+    exit(EXIT_SUCCESS);
+}
+
@@ -76,10 +76,36 @@ void sample_input(GLFWwindow* window)
     cursor_pos = cursor_new;
 }
 
+int coalesce_motion = nk_false;
+int cursor_callback_count = 0, cursor_motion_count = 0;
+double cursor_callback_rate = 0.0, cursor_motion_rate = 0.0;
+double event_latency = 0.0, swap_duration = 0.0;
+
+double mean_timing(GLFWwindow* window, int timing)
+{
+    GLFWhistogram histogram;
+
+    if (!glfwGetWindowHistogram(window, timing, &histogram, GLFW_TRUE) || !histogram.count)
+        return 0.0;
+
+    return histogram.total / histogram.count;
+}
+
+void update_coalesce_motion(GLFWwindow* window)
+{
+    glfwSetInputMode(window, GLFW_COALESCE_MOTION, coalesce_motion == nk_true);
+}
+
 void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos)
 {
+    int count;
+
     cursor_new.x = (float) xpos;
     cursor_new.y = (float) ypos;
+
+    cursor_callback_count++;
+    glfwGetCursorPosHistory(window, &count);
+    cursor_motion_count += count ? count : 1;
 }
 
 int enable_vsync = nk_true;
@@ -221,6 +247,7 @@ int main(int argc, char** argv)
 
     glfwSetKeyCallback(window, key_callback);
     glfwSetCursorPosCallback(window, cursor_pos_callback);
+    glfwSetInputMode(window, GLFW_INSTRUMENTATION, GLFW_TRUE);
 
     while (!glfwWindowShouldClose(window))
     {
@@ -278,6 +305,15 @@ int main(int argc, char** argv)
 
             nk_label(nk, "", 0); // separator
 
+            nk_value_float(nk, "Cursor callbacks per second", (float) cursor_callback_rate);
+            nk_value_float(nk, "Motion events per second", (float) cursor_motion_rate);
+            if (nk_checkbox_label(nk, "Coalesce motion events", &coalesce_motion))
+                update_coalesce_motion(window);
+            nk_value_float(nk, "Mean event latency (ms)", (float) (event_latency * 1000.0));
+            nk_value_float(nk, "Mean swap duration (ms)", (float) (swap_duration * 1000.0));
+
+            nk_label(nk, "", 0); // separator
+
             nk_label(nk, "After swap:", align_left);
             nk_checkbox_label(nk, "glClear", &swap_clear);
             nk_checkbox_label(nk, "glFinish", &swap_finish);
@@ -296,7 +332,13 @@ int main(int argc, char** argv)
         if (current_time - last_time > 1.0)
         {
             frame_rate = frame_count / (current_time - last_time);
+            cursor_callback_rate = cursor_callback_count / (current_time - last_time);
+            cursor_motion_rate = cursor_motion_count / (current_time - last_time);
+            event_latency = mean_timing(window, GLFW_EVENT_LATENCY);
+            swap_duration = mean_timing(window, GLFW_SWAP_DURATION);
             frame_count = 0;
+            cursor_callback_count = 0;
+            cursor_motion_count = 0;
             last_time = current_time;
         }
     }
@@ -0,0 +1,197 @@
+//========================================================================
+// Cursor and icon pixel conversion test and benchmark
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+//
+// This test checks that every pixel conversion kernel supported by the CPU
+// gives exactly the same results as the scalar one, for every combination of
+// color and alpha and for every length up to a few vectors, and then measures
+// how long each kernel takes to convert a large cursor
+//
+//========================================================================
+
+#include "pixel_convert.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "getopt.h"
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(void)
+{
+    printf("Usage: pixels [-s SIZE] [-r ROUNDS]\n");
+    printf("       pixels -h\n");
+}
+
+// Converts the pixels with the kernel and with the scalar reference,
+// returning whether the results are identical
+//
+static int check(PixelKernel kernel, const uint8_t* rgba, size_t count)
+{
+    uint8_t* expected_bgra = malloc(count * 4 + 1);
+    uint8_t* bgra = malloc(count * 4 + 1);
+    long* expected_long = malloc((count + 1) * sizeof(long));
+    long* longs = malloc((count + 1) * sizeof(long));
+    int ok;
+
+    // The guard element catches kernels writing past the end
+    memset(bgra, 0xaa, count * 4 + 1);
+    memset(expected_bgra, 0xaa, count * 4 + 1);
+    memset(longs, 0xaa, (count + 1) * sizeof(long));
+    memset(expected_long, 0xaa, (count + 1) * sizeof(long));
+
+    usePixelKernel(PIXEL_KERNEL_SCALAR);
+    premultiplyToBGRA(expected_bgra, rgba, count);
+    convertToARGB32Long(expected_long, rgba, count);
+
+    usePixelKernel(kernel);
+    premultiplyToBGRA(bgra, rgba, count);
+    convertToARGB32Long(longs, rgba, count);
+
+    ok = memcmp(bgra, expected_bgra, count * 4 + 1) == 0 &&
+         memcmp(longs, expected_long, (count + 1) * sizeof(long)) == 0;
+
+    free(expected_bgra);
+    free(bgra);
+    free(expected_long);
+    free(longs);
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    int ch, k, round, size = 256, rounds = 200, failures = 0;
+    size_t i, count, offset;
+    uint8_t* rgba;
+    uint8_t* bgra;
+    long* longs;
+    double start, elapsed;
+
+    while ((ch = getopt(argc, argv, "hs:r:")) != -1)
+    {
+        switch (ch)
+        {
+            case 'h':
+                usage();
+                exit(EXIT_SUCCESS);
+            case 's':
+                size = atoi(optarg);
+                break;
+            case 'r':
+                rounds = atoi(optarg);
+                break;
+            default:
+                usage();
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (size <= 0 || rounds <= 0)
+    {
+        usage();
+        exit(EXIT_FAILURE);
+    }
+
+    // Every color and alpha pair, with the channels rotated so that each
+    // channel sees every pair, plus a few extra bytes for misaligned starts
+    count = 256 * 256;
+    rgba = malloc(count * 4 + 16);
+    for (i = 0;  i < count;  i++)
+    {
+        rgba[i * 4 + 0] = (uint8_t) i;
+        rgba[i * 4 + 1] = (uint8_t) (i * 7 + 3);
+        rgba[i * 4 + 2] = (uint8_t) (255 - i);
+        rgba[i * 4 + 3] = (uint8_t) (i >> 8);
+    }
+    memset(rgba + count * 4, 0x7f, 16);
+
+    printf("best kernel: %s\n", pixelKernelName(bestPixelKernel()));
+
+    for (k = 0;  k < PIXEL_KERNEL_COUNT;  k++)
+    {
+        int ok = 1;
+
+        if (!usePixelKernel(k))
+        {
+            printf("%-8s not supported\n", pixelKernelName(k));
+            continue;
+        }
+
+        ok = check(k, rgba, count);
+        for (offset = 0;  offset < 4;  offset++)
+        {
+            for (i = 0;  i <= 67;  i++)
+                ok = ok && check(k, rgba + offset * 4 + 1, i);
+        }
+
+        printf("%-8s %s\n", pixelKernelName(k), ok ? "exact" : "MISMATCH");
+        if (!ok)
+            failures++;
+    }
+
+    free(rgba);
+
+    count = (size_t) size * size;
+    rgba = malloc(count * 4);
+    bgra = malloc(count * 4);
+    longs = malloc(count * sizeof(long));
+    for (i = 0;  i < count * 4;  i++)
+        rgba[i] = (uint8_t) (i * 31 + (i >> 9));
+
+    for (k = 0;  k < PIXEL_KERNEL_COUNT;  k++)
+    {
+        if (!usePixelKernel(k))
+            continue;
+
+        start = now();
+        for (round = 0;  round < rounds;  round++)
+            premultiplyToBGRA(bgra, rgba, count);
+        elapsed = now() - start;
+        printf("%-8s premultiply %10.3f ms per %ix%i image %8.2f Gpixels/s\n",
+               pixelKernelName(k), elapsed * 1e3 / rounds, size, size,
+               count * rounds / elapsed / 1e9);
+
+        start = now();
+        for (round = 0;  round < rounds;  round++)
+            convertToARGB32Long(longs, rgba, count);
+        elapsed = now() - start;
+        printf("%-8s icon longs  %10.3f ms per %ix%i image %8.2f Gpixels/s\n",
+               pixelKernelName(k), elapsed * 1e3 / rounds, size, size,
+               count * rounds / elapsed / 1e9);
+    }
+
+    free(rgba);
+    free(bgra);
+    free(longs);
+
+    exit(failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
@@ -0,0 +1,271 @@
+//========================================================================
+// Event loop timer queue benchmark
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+//
+// This test checks the semantics of the timer queue used by the X11 and
+// Wayland event loops: firing order, removal, re-arming, repeating and slot
+// reuse.  It then measures its steady state cost, with hundreds of timers
+// firing and a key repeat style timer being re-armed on every iteration
+//
+//========================================================================
+
+#include "backend_utils.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#include "getopt.h"
+
+static unsigned long long fired = 0;
+
+// The timers fired by the semantic checks, in order
+static int order[16];
+static int order_count = 0;
+static EventLoopData* check_eld = NULL;
+static id_type removed_by_callback = 0;
+static int failures = 0;
+
+// backend_utils.c reports errors through this
+void _glfwInputError(int code, const char* format, ...)
+{
+    va_list vl;
+
+    va_start(vl, format);
+    fprintf(stderr, "Error: ");
+    vfprintf(stderr, format, vl);
+    fprintf(stderr, "\n");
+    va_end(vl);
+}
+
+// backend_utils.c timestamps wakeups with this
+uint64_t _glfwPlatformGetTimerValue(void)
+{
+    return 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static void sleep_for(double seconds)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t) seconds;
+    ts.tv_nsec = (long) ((seconds - (double) ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
+}
+
+static void timer_callback(id_type timer_id, void* data)
+{
+    fired++;
+}
+
+static void record_callback(id_type timer_id, void* data)
+{
+    if (order_count < (int) (sizeof(order) / sizeof(order[0])))
+        order[order_count++] = (int) (intptr_t) data;
+}
+
+static void remove_callback(id_type timer_id, void* data)
+{
+    record_callback(timer_id, data);
+    removeTimer(check_eld, removed_by_callback);
+}
+
+static void check(int condition, const char* description)
+{
+    printf("%-56s %s\n", description, condition ? "OK" : "FAILED");
+    if (!condition)
+        failures++;
+}
+
+static void check_semantics(void)
+{
+    EventLoopData eld = {0};
+    id_type a, b, c;
+    double armed_at;
+    int count;
+
+    check_eld = &eld;
+
+    // Timers expiring in the same dispatch fire in deadline order
+    order_count = 0;
+    addTimer(&eld, "third", 0.003, 1, record_callback, (void*) 3);
+    addTimer(&eld, "first", 0.001, 1, record_callback, (void*) 1);
+    addTimer(&eld, "second", 0.002, 1, record_callback, (void*) 2);
+    sleep_for(0.01);
+    dispatchTimers(&eld);
+    check(order_count == 3 && order[0] == 1 && order[1] == 2 && order[2] == 3,
+          "expired timers fire in deadline order");
+    finalizePollData(&eld);
+
+    // Removed and disabled timers never fire, even when removed by the
+    // callback of a timer firing in the same dispatch
+    order_count = 0;
+    a = addTimer(&eld, "removed", 0.001, 1, record_callback, (void*) 1);
+    addTimer(&eld, "disabled", 0.001, 0, record_callback, (void*) 2);
+    addTimer(&eld, "remover", 0.001, 1, remove_callback, (void*) 3);
+    removed_by_callback = addTimer(&eld, "removed by callback", 0.002, 1, record_callback, (void*) 4);
+    removeTimer(&eld, a);
+    sleep_for(0.01);
+    dispatchTimers(&eld);
+    check(order_count == 1 && order[0] == 3,
+          "removed and disabled timers do not fire");
+    finalizePollData(&eld);
+
+    // A stale id does not remove the timer that reuses its slot
+    order_count = 0;
+    a = addTimer(&eld, "stale", 0.001, 1, record_callback, (void*) 1);
+    removeTimer(&eld, a);
+    b = addTimer(&eld, "reused", 0.001, 1, record_callback, (void*) 2);
+    removeTimer(&eld, a);
+    sleep_for(0.01);
+    dispatchTimers(&eld);
+    check(b != a && order_count == 1 && order[0] == 2,
+          "a stale id does not affect the timer in its slot");
+    finalizePollData(&eld);
+
+    // Re-arming moves the deadline to a full interval from now
+    order_count = 0;
+    c = addTimer(&eld, "re-armed", 0.03, 1, record_callback, (void*) 1);
+    sleep_for(0.02);
+    toggleTimer(&eld, c, 0);
+    toggleTimer(&eld, c, 1);
+    armed_at = now();
+    sleep_for(0.02);
+    dispatchTimers(&eld);
+    check(order_count == 0, "a re-armed timer does not fire at its old deadline");
+    while (!order_count && now() - armed_at < 1.0)
+    {
+        sleep_for(0.001);
+        dispatchTimers(&eld);
+    }
+    check(order_count == 1 && now() - armed_at >= 0.03,
+          "a re-armed timer fires at its new deadline");
+
+    // A timer with a changed interval repeats at the new interval
+    order_count = 0;
+    changeTimerInterval(&eld, c, 0.005);
+    toggleTimer(&eld, c, 0);
+    toggleTimer(&eld, c, 1);
+    armed_at = now();
+    count = 0;
+    while (now() - armed_at < 0.05)
+    {
+        sleep_for(0.001);
+        count += dispatchTimers(&eld);
+    }
+    check(count >= 3 && count <= 10, "an enabled timer repeats at its interval");
+    finalizePollData(&eld);
+
+    check_eld = NULL;
+}
+
+static void usage(void)
+{
+    printf("Usage: timers [-n COUNT] [-s SECONDS]\n");
+    printf("       timers -h\n");
+}
+
+int main(int argc, char** argv)
+{
+    int ch, i, count = 500;
+    double seconds = 2.0;
+    unsigned long long iterations = 0, firing_calls = 0;
+    double dispatch_time = 0.0, firing_time = 0.0, rearm_time = 0.0;
+    double start, end, t, elapsed;
+    EventLoopData eld = {0};
+    id_type repeat_timer;
+
+    while ((ch = getopt(argc, argv, "hn:s:")) != -1)
+    {
+        switch (ch)
+        {
+            case 'h':
+                usage();
+                exit(EXIT_SUCCESS);
+            case 'n':
+                count = atoi(optarg);
+                break;
+            case 's':
+                seconds = atof(optarg);
+                break;
+            default:
+                usage();
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    check_semantics();
+    if (failures)
+        exit(EXIT_FAILURE);
+
+    for (i = 0;  i < count;  i++)
+    {
+        const double interval = 0.001 + 0.099 * (double) rand() / (double) RAND_MAX;
+        if (!addTimer(&eld, "benchmark", interval, 1, timer_callback, NULL))
+            exit(EXIT_FAILURE);
+    }
+
+    repeat_timer = addTimer(&eld, "repeat", 0.03, 1, timer_callback, NULL);
+
+    start = now();
+    end = start + seconds;
+
+    while ((t = now()) < end)
+    {
+        prepareForPoll(&eld, -1);
+        if (dispatchTimers(&eld))
+        {
+            elapsed = now() - t;
+            firing_time += elapsed;
+            firing_calls++;
+        }
+        else
+            elapsed = now() - t;
+        dispatch_time += elapsed;
+
+        t = now();
+        toggleTimer(&eld, repeat_timer, 0);
+        toggleTimer(&eld, repeat_timer, 1);
+        rearm_time += now() - t;
+
+        iterations++;
+    }
+
+    printf("%i timers, %llu iterations, %llu timers fired in %0.2f seconds\n",
+           count + 1, iterations, fired, now() - start);
+    printf("dispatch: %0.1f ns per call, %0.1f ns per call that fired timers\n",
+           dispatch_time * 1e9 / iterations,
+           firing_calls ? firing_time * 1e9 / firing_calls : 0.0);
+    printf("re-arm:   %0.1f ns per toggle\n", rearm_time * 1e9 / (2 * iterations));
+
+    finalizePollData(&eld);
+    exit(EXIT_SUCCESS);
+}
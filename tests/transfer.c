@@ -0,0 +1,237 @@
+//========================================================================
+// Data transfer buffer test
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+//
+// This test sends a large offer through a local pipe, as a clipboard or drag
+// and drop source would, and receives it with the transfer buffer used by the
+// Wayland backend, both into the heap and into a sealed memfd, checking the
+// received contents and reporting the throughput
+//
+//========================================================================
+
+#include "backend_utils.h"
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "getopt.h"
+
+// backend_utils.c reports errors through this
+void _glfwInputError(int code, const char* format, ...)
+{
+    va_list vl;
+
+    va_start(vl, format);
+    fprintf(stderr, "Error: ");
+    vfprintf(stderr, format, vl);
+    fprintf(stderr, "\n");
+    va_end(vl);
+}
+
+// backend_utils.c timestamps wakeups with this
+uint64_t _glfwPlatformGetTimerValue(void)
+{
+    return 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static char pattern(size_t offset)
+{
+    return (char) ('a' + (offset * 7 + offset / 4093) % 26);
+}
+
+// Writes size bytes of the pattern to the pipe from a child process
+//
+static pid_t start_offer(int fd, size_t size)
+{
+    const pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        char buffer[65536];
+        size_t offset = 0;
+
+        while (offset < size)
+        {
+            size_t i, count = size - offset;
+            ssize_t written;
+
+            if (count > sizeof(buffer))
+                count = sizeof(buffer);
+
+            for (i = 0;  i < count;  i++)
+                buffer[i] = pattern(offset + i);
+
+            written = write(fd, buffer, count);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                _exit(EXIT_FAILURE);
+            }
+
+            offset += written;
+        }
+
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(fd);
+    return pid;
+}
+
+static int check_contents(const char* data, size_t size, size_t expected)
+{
+    size_t i;
+
+    if (size != expected)
+    {
+        fprintf(stderr, "Received %zu bytes instead of %zu\n", size, expected);
+        return 0;
+    }
+
+    for (i = 0;  i < size;  i++)
+    {
+        if (data[i] != pattern(i))
+        {
+            fprintf(stderr, "Mismatch at offset %zu\n", i);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int run(const char* name, size_t size, int use_memfd)
+{
+    int fds[2], status, ok = 0;
+    TransferBuffer tb;
+    pid_t pid;
+    ssize_t ret;
+    double start;
+
+    if (pipe(fds) != 0)
+    {
+        perror("pipe");
+        return 0;
+    }
+
+    if (!initTransferBuffer(&tb, use_memfd))
+    {
+        fprintf(stderr, "%s: cannot create transfer buffer: %s\n", name, strerror(errno));
+        close(fds[0]);
+        close(fds[1]);
+        return errno == ENOSYS;
+    }
+
+    start = now();
+    pid = start_offer(fds[1], size);
+
+    while ((ret = readIntoTransferBuffer(&tb, fds[0])) != 0)
+    {
+        if (ret < 0 && errno != EINTR)
+        {
+            perror(name);
+            break;
+        }
+    }
+
+    if (ret == 0 && finishTransferBuffer(&tb))
+    {
+        const double elapsed = now() - start;
+
+        if (tb.fd >= 0)
+        {
+            char* data = tb.size ? mmap(NULL, tb.size, PROT_READ, MAP_PRIVATE, tb.fd, 0) : NULL;
+
+            if (data != MAP_FAILED)
+            {
+                ok = check_contents(data, tb.size, size);
+                if (data)
+                    munmap(data, tb.size);
+            }
+            else
+                perror("mmap");
+        }
+        else
+            ok = check_contents(tb.data, tb.size, size) && tb.data[tb.size] == '\0';
+
+        printf("%-8s %zu bytes in %0.3f seconds, %0.1f MB/s %s\n",
+               name, tb.size, elapsed, tb.size / elapsed / 1e6, ok ? "OK" : "FAILED");
+    }
+
+    close(fds[0]);
+    waitpid(pid, &status, 0);
+    freeTransferBuffer(&tb);
+    return ok;
+}
+
+static void usage(void)
+{
+    printf("Usage: transfer [-s MEGABYTES]\n");
+    printf("       transfer -h\n");
+}
+
+int main(int argc, char** argv)
+{
+    int ch, ok = 1;
+    size_t size = 100 * 1024 * 1024;
+
+    while ((ch = getopt(argc, argv, "hs:")) != -1)
+    {
+        switch (ch)
+        {
+            case 'h':
+                usage();
+                exit(EXIT_SUCCESS);
+            case 's':
+                size = (size_t) (atof(optarg) * 1024 * 1024);
+                break;
+            default:
+                usage();
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    ok &= run("heap", size, 0);
+    ok &= run("memfd", size, 1);
+    ok &= run("empty", 0, 0);
+
+    exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
@@ -0,0 +1,247 @@
+//========================================================================
+// Empty event wakeup benchmark
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any damages
+// arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would
+//    be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such, and must not
+//    be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source
+//    distribution.
+//
+//========================================================================
+//
+// This test measures how quickly glfwPostEmptyEvent wakes up a thread
+// blocked in glfwWaitEvents, and how many posts per second can be made from
+// multiple producer threads
+//
+//========================================================================
+
+#include "tinycthread.h"
+
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "getopt.h"
+
+static volatile int running = GLFW_TRUE;
+static volatile int posted = 0, acknowledged = 0;
+static volatile double post_time = 0.0;
+static int samples = 1000;
+
+static void error_callback(int error, const char* description)
+{
+    fprintf(stderr, "Error: %s\n", description);
+}
+
+static void usage(void)
+{
+    printf("Usage: wakeup [-t THREADS] [-n SAMPLES] [-s SECONDS]\n");
+    printf("       wakeup -h\n");
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+    const double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+static int latency_thread_main(void* data)
+{
+    int i;
+
+    for (i = 0;  i < samples;  i++)
+    {
+        // Give the main thread time to block before posting
+        struct timespec delay = { 0, 1000000 };
+        thrd_sleep(&delay, NULL);
+
+        post_time = glfwGetTime();
+        posted = i + 1;
+        glfwPostEmptyEvent();
+
+        while (acknowledged != posted)
+            thrd_yield();
+    }
+
+    return 0;
+}
+
+static int throughput_thread_main(void* data)
+{
+    unsigned long long* count = data;
+
+    while (running)
+    {
+        glfwPostEmptyEvent();
+        (*count)++;
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int ch, i, result, thread_count = 4;
+    double seconds = 2.0, start, end;
+    GLFWwindow* window;
+    double* latencies;
+    thrd_t thread;
+    thrd_t* threads;
+    unsigned long long* posts;
+    unsigned long long total_posts = 0, wakeups = 0;
+
+    while ((ch = getopt(argc, argv, "hn:s:t:")) != -1)
+    {
+        switch (ch)
+        {
+            case 'h':
+                usage();
+                exit(EXIT_SUCCESS);
+            case 'n':
+                samples = atoi(optarg);
+                break;
+            case 's':
+                seconds = atof(optarg);
+                break;
+            case 't':
+                thread_count = atoi(optarg);
+                break;
+            default:
+                usage();
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (samples < 1 || thread_count < 1)
+    {
+        usage();
+        exit(EXIT_FAILURE);
+    }
+
+    glfwSetErrorCallback(error_callback);
+
+    if (!glfwInit())
+        exit(EXIT_FAILURE);
+
+    // The wait functions return at once if there are no windows
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+
+    window = glfwCreateWindow(64, 64, "Wakeup", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        exit(EXIT_FAILURE);
+    }
+
+    // With nothing posted a wait must block, or the results below would only
+    // time a busy loop.  The window may have events of its own pending, so
+    // the wait is given a few tries
+    glfwPollEvents();
+
+    for (i = 0;  i < 5;  i++)
+    {
+        start = glfwGetTime();
+        glfwWaitEventsTimeout(0.1);
+        if (glfwGetTime() - start >= 0.05)
+            break;
+    }
+
+    if (i == 5)
+    {
+        fprintf(stderr, "Waiting for events does not block on this platform\n");
+
+        glfwTerminate();
+        exit(EXIT_FAILURE);
+    }
+
+    latencies = calloc(samples, sizeof(double));
+    threads = calloc(thread_count, sizeof(thrd_t));
+    posts = calloc(thread_count, sizeof(unsigned long long));
+
+    // Latency: a single producer posts while the main thread is waiting
+    if (thrd_create(&thread, latency_thread_main, NULL) != thrd_success)
+    {
+        fprintf(stderr, "Failed to create secondary thread\n");
+
+        glfwTerminate();
+        exit(EXIT_FAILURE);
+    }
+
+    while (acknowledged < samples)
+    {
+        glfwWaitEvents();
+
+        if (posted != acknowledged)
+        {
+            latencies[acknowledged] = glfwGetTime() - post_time;
+            acknowledged = posted;
+        }
+    }
+
+    thrd_join(thread, &result);
+    qsort(latencies, samples, sizeof(double), compare_doubles);
+
+    printf("latency over %i wakeups: min %0.1f us, median %0.1f us, 99%% %0.1f us, max %0.1f us\n",
+           samples,
+           latencies[0] * 1e6,
+           latencies[samples / 2] * 1e6,
+           latencies[(int) (samples * 0.99)] * 1e6,
+           latencies[samples - 1] * 1e6);
+
+    // Throughput: all producers post as fast as they can
+    for (i = 0;  i < thread_count;  i++)
+    {
+        if (thrd_create(threads + i, throughput_thread_main, posts + i) != thrd_success)
+        {
+            fprintf(stderr, "Failed to create secondary thread\n");
+
+            glfwTerminate();
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    end = glfwGetTime() + seconds;
+
+    while (glfwGetTime() < end)
+    {
+        glfwWaitEvents();
+        wakeups++;
+    }
+
+    running = GLFW_FALSE;
+
+    for (i = 0;  i < thread_count;  i++)
+    {
+        thrd_join(threads[i], &result);
+        total_posts += posts[i];
+    }
+
+    printf("throughput with %i threads: %0.0f posts/s, %0.0f wakeups/s, %0.1f posts per wakeup\n",
+           thread_count,
+           total_posts / seconds,
+           wakeups / seconds,
+           wakeups ? (double) total_posts / wakeups : 0.0);
+
+    free(latencies);
+    free(threads);
+    free(posts);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    exit(EXIT_SUCCESS);
+}